@@ -0,0 +1,38 @@
+#include "input/input.h"
+
+#include <GLFW/glfw3.h>
+#include <benchmark/benchmark.h>
+
+namespace {
+
+// A frame of input: keys are pressed and released again, then the frame state is reset.
+void input_state_churn(benchmark::State& state)
+{
+    auto const keys = static_cast<int>(state.range(0));
+
+    entt::registry registry;
+    registry.ctx().emplace<Input::State<Input::KeyCode>>();
+    Input::KeyListener key_listener{registry};
+
+    for (auto _ : state) {
+        for (int key = 0; key < keys; ++key) {
+            key_listener.key_event(
+                Input::KeyInput{.key_code = static_cast<Input::KeyCode>(key),
+                                .action = static_cast<Input::Action>(GLFW_PRESS)});
+        }
+
+        for (int key = 0; key < keys; ++key) {
+            key_listener.key_event(
+                Input::KeyInput{.key_code = static_cast<Input::KeyCode>(key),
+                                .action = static_cast<Input::Action>(GLFW_RELEASE)});
+        }
+
+        Input::State<Input::KeyCode>::update_state(registry);
+    }
+
+    state.SetItemsProcessed(state.iterations() * keys * 2);
+}
+
+BENCHMARK(input_state_churn)->ArgNames({"keys"})->Arg(4)->Arg(64);
+
+} // namespace
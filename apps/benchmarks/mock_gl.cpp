@@ -0,0 +1,140 @@
+#include "mock_gl.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace MockGl {
+
+namespace {
+
+struct Program
+{
+    std::vector<Uniform> uniforms;
+    std::vector<GLint> locations;
+    GLuint next_object = 1;
+};
+
+Program program;
+
+auto GLAD_API_PTR create_object() -> GLuint
+{
+    return program.next_object++;
+}
+
+auto GLAD_API_PTR create_shader(GLenum /*type*/) -> GLuint
+{
+    return program.next_object++;
+}
+
+void GLAD_API_PTR no_op_object(GLuint /*object*/) {}
+
+void GLAD_API_PTR no_op_attach(GLuint /*program*/, GLuint /*shader*/) {}
+
+void GLAD_API_PTR shader_source(GLuint /*shader*/,
+                                GLsizei /*count*/,
+                                GLchar const* const* /*string*/,
+                                GLint const* /*length*/)
+{
+}
+
+void GLAD_API_PTR get_status(GLuint /*object*/, GLenum /*pname*/, GLint* params)
+{
+    *params = GL_TRUE;
+}
+
+void GLAD_API_PTR get_program_interface(GLuint /*program*/,
+                                        GLenum interface,
+                                        GLenum pname,
+                                        GLint* params)
+{
+    if (interface != GL_UNIFORM) {
+        *params = 0;
+        return;
+    }
+
+    if (pname == GL_ACTIVE_RESOURCES) {
+        *params = static_cast<GLint>(program.uniforms.size());
+        return;
+    }
+
+    std::size_t max_length = 0;
+    for (auto const& uniform : program.uniforms) {
+        max_length = std::max(max_length, uniform.name.size() + 1);
+    }
+    *params = static_cast<GLint>(max_length);
+}
+
+void GLAD_API_PTR get_program_resource(GLuint /*program*/,
+                                       GLenum /*interface*/,
+                                       GLuint index,
+                                       GLsizei property_count,
+                                       GLenum const* properties,
+                                       GLsizei /*count*/,
+                                       GLsizei* /*length*/,
+                                       GLint* params)
+{
+    auto const& uniform = program.uniforms.at(index);
+
+    for (GLsizei i = 0; i < property_count; ++i) {
+        switch (properties[i]) {
+        case GL_LOCATION:
+            params[i] = program.locations.at(index);
+            break;
+        case GL_TYPE:
+            params[i] = static_cast<GLint>(uniform.type);
+            break;
+        case GL_ARRAY_SIZE:
+            params[i] = uniform.array_size;
+            break;
+        default:
+            params[i] = 0;
+        }
+    }
+}
+
+void GLAD_API_PTR get_program_resource_name(GLuint /*program*/,
+                                            GLenum /*interface*/,
+                                            GLuint index,
+                                            GLsizei buffer_size,
+                                            GLsizei* length,
+                                            GLchar* name)
+{
+    auto const& uniform_name = program.uniforms.at(index).name;
+    auto const copied = std::min(uniform_name.size(), static_cast<std::size_t>(buffer_size - 1));
+
+    std::memcpy(name, uniform_name.data(), copied);
+    name[copied] = '\0';
+    *length = static_cast<GLsizei>(copied);
+}
+
+} // namespace
+
+void install(std::vector<Uniform> uniforms)
+{
+    // Arrays occupy consecutive locations
+    program.locations.clear();
+    GLint location = 0;
+    for (auto const& uniform : uniforms) {
+        program.locations.push_back(location);
+        location += uniform.array_size;
+    }
+    program.uniforms = std::move(uniforms);
+
+    glad_glCreateProgram = create_object;
+    glad_glCreateShader = create_shader;
+    glad_glShaderSource = shader_source;
+    glad_glCompileShader = no_op_object;
+    glad_glGetShaderiv = get_status;
+    glad_glAttachShader = no_op_attach;
+    glad_glDetachShader = no_op_attach;
+    glad_glLinkProgram = no_op_object;
+    glad_glGetProgramiv = get_status;
+    glad_glDeleteShader = no_op_object;
+    glad_glDeleteProgram = no_op_object;
+    glad_glUseProgram = no_op_object;
+    glad_glGetProgramInterfaceiv = get_program_interface;
+    glad_glGetProgramResourceiv = get_program_resource;
+    glad_glGetProgramResourceName = get_program_resource_name;
+}
+
+} // namespace MockGl
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <string>
+#include <vector>
+
+// A fake driver for the GL entry points used to create shaders. Every shader compiles and links,
+// programs report the given uniforms, so shaders can be created without a context.
+namespace MockGl {
+
+struct Uniform
+{
+    std::string name;
+    GLenum type;
+    GLint array_size = 1;
+};
+
+void install(std::vector<Uniform> uniforms);
+
+} // namespace MockGl
@@ -0,0 +1,206 @@
+#include "core/graphics/image.h"
+#include "core/shader.h"
+#include "mock_gl.h"
+#include "scene/gltf_loader.h"
+
+#include <benchmark/benchmark.h>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+
+using namespace entt::literals;
+
+namespace {
+
+template <typename T> void append_buffer_view(fx::gltf::Document& gltf, std::vector<T> const& data)
+{
+    auto& buffer = gltf.buffers.front().data;
+    auto const offset = buffer.size();
+    auto const size = data.size() * sizeof(T);
+
+    buffer.resize(offset + size);
+    std::memcpy(buffer.data() + offset, data.data(), size);
+
+    fx::gltf::BufferView buffer_view;
+    buffer_view.buffer = 0;
+    buffer_view.byteOffset = static_cast<std::uint32_t>(offset);
+    buffer_view.byteLength = static_cast<std::uint32_t>(size);
+    gltf.bufferViews.push_back(buffer_view);
+}
+
+auto accessor(std::size_t buffer_view,
+              fx::gltf::Accessor::ComponentType component_type,
+              fx::gltf::Accessor::Type type) -> fx::gltf::Accessor
+{
+    fx::gltf::Accessor accessor;
+    accessor.bufferView = static_cast<std::int32_t>(buffer_view);
+    accessor.componentType = component_type;
+    accessor.type = type;
+    return accessor;
+}
+
+// A document holding a single primitive of the given number of vertices and as many indices.
+auto primitive_document(std::size_t vertices) -> fx::gltf::Document
+{
+    using ComponentType = fx::gltf::Accessor::ComponentType;
+    using Type = fx::gltf::Accessor::Type;
+
+    fx::gltf::Document gltf;
+    gltf.buffers.emplace_back();
+
+    fx::gltf::Primitive primitive;
+    auto add_attribute = [&gltf, &primitive](std::string const& name, auto const& data, Type type) {
+        append_buffer_view(gltf, data);
+        primitive.attributes[name] = static_cast<std::uint32_t>(gltf.accessors.size());
+        gltf.accessors.push_back(accessor(gltf.bufferViews.size() - 1, ComponentType::Float, type));
+    };
+
+    add_attribute("POSITION", std::vector<std::array<float, 3>>(vertices), Type::Vec3);
+    add_attribute("NORMAL", std::vector<std::array<float, 3>>(vertices), Type::Vec3);
+    add_attribute("TANGENT", std::vector<std::array<float, 4>>(vertices), Type::Vec4);
+    add_attribute("TEXCOORD_0", std::vector<std::array<float, 2>>(vertices), Type::Vec2);
+
+    std::vector<std::uint32_t> indices(vertices);
+    std::iota(indices.begin(), indices.end(), 0);
+    append_buffer_view(gltf, indices);
+    primitive.indices = static_cast<std::int32_t>(gltf.accessors.size());
+    gltf.accessors.push_back(
+        accessor(gltf.bufferViews.size() - 1, ComponentType::UnsignedInt, Type::Scalar));
+
+    fx::gltf::Material material;
+    material.name = "material";
+    gltf.materials.push_back(material);
+    primitive.material = 0;
+
+    fx::gltf::Mesh mesh;
+    mesh.primitives.push_back(primitive);
+    gltf.meshes.push_back(mesh);
+
+    return gltf;
+}
+
+void gltf_load_primitive(benchmark::State& state)
+{
+    auto const gltf = primitive_document(static_cast<std::size_t>(state.range(0)));
+    auto const& primitive = gltf.meshes.front().primitives.front();
+
+    entt::resource_cache<Material> material_cache;
+    entt::resource_cache<Mesh> mesh_cache;
+
+    for (auto _ : state) {
+        // Meshes are only loaded once per identifier
+        state.PauseTiming();
+        mesh_cache.clear();
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(
+            load_gltf_primitive(primitive, gltf, "primitive", material_cache, mesh_cache));
+    }
+
+    state.SetBytesProcessed(state.iterations() *
+                            static_cast<std::int64_t>(gltf.buffers.front().data.size()));
+}
+
+BENCHMARK(gltf_load_primitive)->ArgNames({"vertices"})->Arg(1'000)->Arg(100'000);
+
+// The fixture holds smooth gradients with a little grain, compressed by a regular encoder with
+// a filter per row, so decoding exercises the Huffman decoder and the row filters like a texture
+// would.
+void image_decode(benchmark::State& state)
+{
+    std::ifstream file(FEVER_BENCHMARK_DATA_DIRECTORY "/gradient.png", std::ios::binary);
+    std::vector<std::uint8_t> const png(std::istreambuf_iterator<char>(file), {});
+    if (png.empty()) {
+        state.SkipWithError("Could not read the image fixture");
+        return;
+    }
+
+    std::size_t decoded_size = 0;
+    for (auto _ : state) {
+        Image image(png, Image::ColorFormat::SRGB);
+        benchmark::DoNotOptimize(image.data.data());
+        decoded_size = image.data.size();
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(decoded_size));
+}
+
+BENCHMARK(image_decode);
+
+// Uniforms of a material shader: matrices, a few scalars and an array of point lights.
+auto material_uniforms() -> std::vector<MockGl::Uniform>
+{
+    std::vector<MockGl::Uniform> uniforms{{"u_modelMatrix", GL_FLOAT_MAT4},
+                                          {"u_viewProjectionMatrix", GL_FLOAT_MAT4},
+                                          {"u_normalMatrix", GL_FLOAT_MAT3},
+                                          {"u_viewPosition", GL_FLOAT_VEC3},
+                                          {"u_exposure", GL_FLOAT},
+                                          {"u_baseColorTexture", GL_SAMPLER_2D},
+                                          {"u_normalMapTexture", GL_SAMPLER_2D},
+                                          {"u_cascadeSplits[0]", GL_FLOAT, 4}};
+
+    for (int light = 0; light < 16; ++light) {
+        auto prefix = "u_pointLight[" + std::to_string(light) + "].";
+        uniforms.push_back({prefix + "position", GL_FLOAT_VEC3});
+        uniforms.push_back({prefix + "color", GL_FLOAT_VEC3});
+        uniforms.push_back({prefix + "intensity", GL_FLOAT});
+    }
+
+    return uniforms;
+}
+
+// Includes reading the shader files, as loading a shader does.
+void shader_introspect(benchmark::State& state)
+{
+    MockGl::install(material_uniforms());
+
+    for (auto _ : state) {
+        Shader shader(Material::SHADER_NAME, FEVER_SHADER_DIRECTORY);
+        benchmark::DoNotOptimize(shader.uniform<glm::mat4>("u_modelMatrix"_hs));
+    }
+}
+
+BENCHMARK(shader_introspect);
+
+void shader_uniform_lookup(benchmark::State& state)
+{
+    MockGl::install(material_uniforms());
+    Shader shader(Material::SHADER_NAME, FEVER_SHADER_DIRECTORY);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(shader.uniform<glm::mat4>("u_modelMatrix"_hs));
+        benchmark::DoNotOptimize(shader.uniform<glm::vec3>("u_pointLight[7].color"_hs));
+        benchmark::DoNotOptimize(shader.uniform<float>("u_cascadeSplits[3]"_hs));
+    }
+
+    state.SetItemsProcessed(state.iterations() * 3);
+}
+
+BENCHMARK(shader_uniform_lookup);
+
+// Names built at runtime are hashed on every lookup.
+void shader_uniform_lookup_runtime_name(benchmark::State& state)
+{
+    MockGl::install(material_uniforms());
+    Shader shader(Material::SHADER_NAME, FEVER_SHADER_DIRECTORY);
+
+    std::vector<std::string> names;
+    for (int light = 0; light < 16; ++light) {
+        names.push_back("u_pointLight[" + std::to_string(light) + "].color");
+    }
+
+    for (auto _ : state) {
+        for (auto const& name : names) {
+            benchmark::DoNotOptimize(
+                shader.uniform<glm::vec3>(entt::hashed_string::value(name.data(), name.size())));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(names.size()));
+}
+
+BENCHMARK(shader_uniform_lookup_runtime_name);
+
+} // namespace
@@ -0,0 +1,163 @@
+#include "components/relationship.h"
+#include "components/transform.h"
+#include "core/cluster_grid.h"
+#include "scene/gltf.h"
+
+#include <benchmark/benchmark.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <optional>
+#include <random>
+#include <string>
+
+namespace {
+
+// Chains of depth + 1 entities, every entity the child of the one before.
+void spawn_hierarchies(entt::registry& registry, std::size_t entities, std::size_t depth)
+{
+    entt::entity parent = entt::null;
+
+    for (std::size_t i = 0; i < entities; ++i) {
+        auto entity = registry.create();
+        registry.emplace<Transform>(entity, Transform{.translation = glm::vec3(1.0F)});
+        registry.emplace<GlobalTransform>(entity);
+
+        if (i % (depth + 1) != 0) {
+            registry.emplace<Parent>(entity, Parent{.parent = parent});
+            registry.get_or_emplace<Children>(parent).children.push_back(entity);
+        }
+
+        parent = entity;
+    }
+}
+
+void global_transform_update(benchmark::State& state)
+{
+    entt::registry registry;
+    spawn_hierarchies(registry,
+                      static_cast<std::size_t>(state.range(0)),
+                      static_cast<std::size_t>(state.range(1)));
+
+    for (auto _ : state) {
+        GlobalTransform::update(registry);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(global_transform_update)
+    ->ArgNames({"entities", "depth"})
+    ->Args({1'000, 0})
+    ->Args({100'000, 0})
+    ->Args({100'000, 3})
+    ->Args({100'000, 15})
+    ->Args({1'000'000, 3});
+
+void global_transform_from_transform(benchmark::State& state)
+{
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> unit(-1.0F, 1.0F);
+
+    std::vector<Transform> transforms(1024);
+    for (auto& transform : transforms) {
+        glm::quat orientation(1.0F, unit(random), unit(random), unit(random));
+        transform = Transform{.translation = {unit(random), unit(random), unit(random)},
+                              .orientation = glm::normalize(orientation),
+                              .scale = glm::vec3(1.0F + unit(random))};
+    }
+
+    for (auto _ : state) {
+        for (auto const& transform : transforms) {
+            GlobalTransform global_transform(transform);
+            benchmark::DoNotOptimize(global_transform);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(transforms.size()));
+}
+
+BENCHMARK(global_transform_from_transform);
+
+// The scalar sphere-box tests of the light assignment, lights spread over the whole frustum.
+void cluster_grid_assign(benchmark::State& state)
+{
+    constexpr float NEAR = 0.1F;
+    constexpr float FAR = 100.0F;
+
+    ClusterGrid grid;
+    grid.set_projection(glm::perspective(glm::radians(60.0F), 16.0F / 9.0F, NEAR, FAR), NEAR, FAR);
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> unit(-1.0F, 1.0F);
+    std::uniform_real_distribution<float> depth(NEAR, FAR);
+    std::uniform_real_distribution<float> radius(0.5F, 5.0F);
+
+    std::vector<ClusterGrid::Sphere> lights(static_cast<std::size_t>(state.range(0)));
+    for (auto& light : lights) {
+        float const z = depth(random);
+        light = ClusterGrid::Sphere{.center = {unit(random) * z, unit(random) * z * 0.6F, -z},
+                                    .radius = radius(random)};
+    }
+
+    for (auto _ : state) {
+        grid.assign(lights);
+        benchmark::DoNotOptimize(grid.light_indices().data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(cluster_grid_assign)->ArgNames({"lights"})->Arg(64)->Arg(1'024)->Arg(16'384);
+
+// A glTF scene of root nodes with one primitive each, like a scene of many props.
+void gltf_spawn_scene(benchmark::State& state)
+{
+    auto const node_count = static_cast<std::size_t>(state.range(0));
+
+    entt::resource_cache<Mesh> mesh_cache;
+    entt::resource_cache<Material> material_cache;
+    entt::resource_cache<GltfMesh> gltf_mesh_cache;
+    entt::resource_cache<GltfNode> node_cache;
+
+    auto mesh = mesh_cache.load(entt::hashed_string("mesh"), Mesh{}).first->second;
+    auto material = material_cache.load(entt::hashed_string("material"), Material{}).first->second;
+    auto gltf_mesh =
+        gltf_mesh_cache
+            .load(entt::hashed_string("mesh"),
+                  GltfMesh{.primitives = {GltfPrimitive{.mesh = mesh, .material = material}}})
+            .first->second;
+
+    Gltf gltf;
+    gltf.document.scenes.emplace_back();
+
+    for (std::size_t i = 0; i < node_count; ++i) {
+        std::string name = "node." + std::to_string(i);
+        node_cache.load(entt::hashed_string(name.c_str()),
+                        GltfNode{.name = name,
+                                 .transform = Transform{},
+                                 .mesh = gltf_mesh,
+                                 .camera = {},
+                                 .children = {}});
+
+        fx::gltf::Node node;
+        node.name = name;
+        node.mesh = 0;
+        gltf.document.nodes.push_back(node);
+        gltf.document.scenes.front().nodes.push_back(static_cast<std::uint32_t>(i));
+    }
+
+    std::optional<entt::registry> registry;
+    for (auto _ : state) {
+        state.PauseTiming();
+        registry.emplace();
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(gltf.spawn_scene(std::size_t{0}, *registry, node_cache));
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(gltf_spawn_scene)->ArgNames({"nodes"})->Arg(100)->Arg(10'000);
+
+} // namespace
@@ -5,22 +5,43 @@
 #include "components/transform.h"
 #include "core/camera.h"
 #include "core/light.h"
+#include "core/time.h"
 #include "window/window.h"
 
 #include <spdlog/spdlog.h>
 
 using namespace entt::literals;
 
-Controller::Controller(std::string_view path)
+Controller::Controller(std::string_view path,
+                       std::optional<StressScene::Parameters> const& stress_scene,
+                       Options const& options) :
+    Application(options)
 {
-    spdlog::info("Open {}", path);
-    std::filesystem::path document_path(path);
-    entt::hashed_string document_hash(document_path.string().c_str());
+    if (stress_scene.has_value()) {
+        scheduler.add(Scheduler::Stage::FixedUpdate,
+                      "stress_scene_animate",
+                      Scheduler::Access{}
+                          .read<StressScene::Mover>()
+                          .write<Transform>()
+                          .read_context<Time::FixedStep>(),
+                      &StressScene::animate);
 
-    entt::resource<Gltf> gltf_document =
-        gltf_cache.load(document_hash, document_path).first->second;
+        StressScene::spawn(registry(),
+                           StressScene::Caches{.mesh_cache = mesh_cache,
+                                               .material_cache = material_cache,
+                                               .image_cache = image_cache,
+                                               .shader_cache = shader_cache},
+                           stress_scene.value());
+    } else {
+        spdlog::info("Open {}", path);
+        std::filesystem::path document_path(path);
+        entt::hashed_string document_hash(document_path.string().c_str());
 
-    gltf_document->spawn_default_scene(registry(), gltf_node_cache);
+        entt::resource<Gltf> gltf_document =
+            gltf_cache.load(document_hash, document_path).first->second;
+
+        gltf_document->spawn_default_scene(registry(), gltf_node_cache);
+    }
 
     // Spawn default lights
     auto directional_light = registry().create();
@@ -1,13 +1,18 @@
 #pragma once
 
 #include "core/application.h"
+#include "scene/stress_scene.h"
 
 #include <entt/entt.hpp>
 #include <glm/glm.hpp>
+#include <optional>
 
 class Controller : public FeverCore::Application
 {
 public:
-    Controller(std::string_view path);
+    // Spawns a generated stress scene instead of the model when its parameters are given.
+    Controller(std::string_view path,
+               std::optional<StressScene::Parameters> const& stress_scene,
+               Options const& options);
     void update() override;
 };
@@ -1,9 +1,14 @@
 #include "controller.h"
 #include "util/log.h"
+#include "window/window.h"
 
 #include <GLFW/glfw3.h>
 #include <cxxopts.hpp>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
 #include <iostream>
+#include <optional>
 #include <spdlog/spdlog.h>
 
 auto main(int argc, char* argv[]) -> int
@@ -15,6 +20,42 @@ auto main(int argc, char* argv[]) -> int
     // clang-format off
     options.add_options()
         ("model", "Model file to load", cxxopts::value<std::string>())
+        ("headless", "Render without a window and exit after a number of frames")
+        ("frames", "Frames of a headless run", cxxopts::value<unsigned>()->default_value("300"))
+        ("capture-interval",
+            "Frames between captured frames, 0 for the last frame of a headless run only",
+            cxxopts::value<unsigned>()->default_value("0"))
+        ("capture-format", "Format of captured frames, png or y4m",
+            cxxopts::value<std::string>()->default_value("png"))
+        ("reference", "Directory of reference images to compare captured frames against",
+            cxxopts::value<std::string>())
+        ("output", "Output directory of captured frames and headless timings",
+            cxxopts::value<std::string>()->default_value("headless"))
+        ("record", "Record the input into a file", cxxopts::value<std::string>())
+        ("replay", "Replay a recorded input file", cxxopts::value<std::string>())
+        ("benchmark", "Write benchmark statistics as JSON", cxxopts::value<std::string>())
+        ("baseline", "Benchmark JSON to compare against", cxxopts::value<std::string>())
+        ("stress", "Spawn a generated stress scene of this many entities instead of the model",
+            cxxopts::value<std::size_t>())
+        ("stress-meshes", "Unique meshes of the stress scene",
+            cxxopts::value<std::size_t>()->default_value("16"))
+        ("stress-materials", "Materials of the stress scene",
+            cxxopts::value<std::size_t>()->default_value("8"))
+        ("stress-depth", "Hierarchy depth of the stress scene",
+            cxxopts::value<unsigned>()->default_value("0"))
+        ("stress-lights", "Point lights of the stress scene",
+            cxxopts::value<std::size_t>()->default_value("16"))
+        ("stress-moving", "Fraction of moving entities in the stress scene",
+            cxxopts::value<float>()->default_value("0.1"))
+        ("stress-seed", "Random seed of the stress scene",
+            cxxopts::value<std::uint32_t>()->default_value("1"))
+        ("validate-systems", "Run the systems serially and report undeclared component writes")
+        ("tick-rate", "Fixed steps per second of the simulation",
+            cxxopts::value<double>()->default_value("60"))
+        ("no-render-thread", "Simulate and render every frame in turn on the main thread")
+        ("fps", "Limit the frame rate, 0 for unlimited",
+            cxxopts::value<double>()->default_value("0"))
+        ("on-demand", "Only render frames that changed and wait for input while idle")
         ("h,help", "Print usage")
     ;
     // clang-format on
@@ -32,18 +73,76 @@ auto main(int argc, char* argv[]) -> int
     if (result.count("model"))
         model = result["model"].as<std::string>();
 
+    auto optional_path =
+        [&result](std::string const& name) -> std::optional<std::filesystem::path> {
+        if (result.count(name) == 0) {
+            return {};
+        }
+        return result[name].as<std::string>();
+    };
+
+    auto const capture_format = result["capture-format"].as<std::string>();
+    if (capture_format != "png" && capture_format != "y4m") {
+        spdlog::critical(R"(Unknown capture format "{}", expected png or y4m)", capture_format);
+        return -1;
+    }
+
+    // The fixed step is the inverse of the rate, so it has to be positive and finite
+    auto const tick_rate = result["tick-rate"].as<double>();
+    if (!std::isfinite(tick_rate) || tick_rate <= 0.0) {
+        spdlog::critical("Tick rate must be a positive number, got {}", tick_rate);
+        return -1;
+    }
+
+    FeverCore::Application::Options application_options{
+        .headless = result.count("headless") != 0,
+        .frame_count = result["frames"].as<unsigned>(),
+        .capture_interval = result["capture-interval"].as<unsigned>(),
+        .capture_format =
+            capture_format == "y4m" ? FrameCapture::Format::Y4m : FrameCapture::Format::Png,
+        .output_directory = result["output"].as<std::string>(),
+        .reference_directory = optional_path("reference"),
+        .record_path = optional_path("record"),
+        .replay_path = optional_path("replay"),
+        .benchmark_path = optional_path("benchmark"),
+        .baseline_path = optional_path("baseline"),
+        .validate_systems = result.count("validate-systems") != 0,
+        .fixed_rate = tick_rate,
+        .render_thread = result.count("no-render-thread") == 0,
+        .target_fps = result["fps"].as<double>(),
+        .on_demand = result.count("on-demand") != 0};
+
+    std::optional<StressScene::Parameters> stress_scene;
+    if (result.count("stress")) {
+        stress_scene = StressScene::Parameters{
+            .entities = result["stress"].as<std::size_t>(),
+            .unique_meshes = result["stress-meshes"].as<std::size_t>(),
+            .materials = result["stress-materials"].as<std::size_t>(),
+            .hierarchy_depth = result["stress-depth"].as<unsigned>(),
+            .point_lights = result["stress-lights"].as<std::size_t>(),
+            .moving_fraction = result["stress-moving"].as<float>(),
+            .seed = result["stress-seed"].as<std::uint32_t>()};
+    }
+
+    if (application_options.headless) {
+        Window::prefer_headless_platform();
+    }
+
     // Initialize GLFW
     if (glfwInit() == 0) {
         spdlog::critical("Could not initialize GLFW");
         return -1;
     }
 
+    int exit_code = 0;
+
     {
         // Create controller
-        Controller controller(model);
+        Controller controller(model, stress_scene, application_options);
         controller.run();
+        exit_code = controller.exit_code();
     }
 
     glfwTerminate();
-    return 0;
+    return exit_code;
 }
@@ -0,0 +1,70 @@
+#include "util/image_diff.h"
+#include "util/log.h"
+#include "util/png.h"
+
+#include <cxxopts.hpp>
+#include <iostream>
+#include <spdlog/spdlog.h>
+
+// Compares a rendered frame against its reference image. Exits with 0 if they match, 1 if they
+// differ and 2 if an image could not be loaded.
+auto main(int argc, char* argv[]) -> int
+{
+    Log::initialize();
+
+    cxxopts::Options options("Fever-ImageDiff", "Perceptual comparison of two images");
+
+    // clang-format off
+    options.add_options()
+        ("reference", "Reference image", cxxopts::value<std::string>())
+        ("candidate", "Image to compare", cxxopts::value<std::string>())
+        ("delta-e", "Color difference a pixel may have",
+            cxxopts::value<float>()->default_value("2.3"))
+        ("radius", "Distance in pixels a matching reference pixel may have",
+            cxxopts::value<unsigned>()->default_value("1"))
+        ("max-fraction", "Fraction of pixels allowed to differ",
+            cxxopts::value<float>()->default_value("0"))
+        ("output", "Writes the differing pixels into this image", cxxopts::value<std::string>())
+        ("h,help", "Print usage")
+    ;
+    // clang-format on
+
+    options.parse_positional({"reference", "candidate"});
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help") || !result.count("reference") || !result.count("candidate")) {
+        std::cout << options.help() << std::endl;
+        return result.count("help") ? 0 : 2;
+    }
+
+    auto reference = ImageDiff::load(result["reference"].as<std::string>());
+    auto candidate = ImageDiff::load(result["candidate"].as<std::string>());
+    if (!reference.has_value() || !candidate.has_value()) {
+        return 2;
+    }
+
+    ImageDiff::Tolerance tolerance{.delta_e = result["delta-e"].as<float>(),
+                                   .search_radius = result["radius"].as<unsigned>(),
+                                   .max_differing_fraction = result["max-fraction"].as<float>()};
+
+    auto diff = ImageDiff::compare(reference.value(), candidate.value(), tolerance);
+    if (!diff.has_value()) {
+        spdlog::error("The images differ in size");
+        return 1;
+    }
+
+    std::cout << "differing pixels: " << diff->differing_pixels << " ("
+              << diff->differing_fraction * 100.0F << "%)\n"
+              << "max delta E: " << diff->max_delta_e << '\n'
+              << "mean delta E: " << diff->mean_delta_e << '\n';
+
+    if (result.count("output")) {
+        Png::write(result["output"].as<std::string>(),
+                   diff->visualization.dimensions,
+                   diff->visualization.rgba,
+                   Png::RowOrder::TopToBottom);
+    }
+
+    return diff->passed ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+#include "core/command_buffer.h"
+
+#include <spdlog/spdlog.h>
+#include <string_view>
+
+namespace {
+
+struct Value
+{
+    int value;
+};
+
+int failures = 0;
+
+void check(bool condition, std::string_view description)
+{
+    if (!condition) {
+        spdlog::error("Failed: {}", description);
+        ++failures;
+    }
+}
+
+auto value_of(entt::registry const& registry, entt::entity entity) -> int
+{
+    auto const* value = registry.try_get<Value>(entity);
+    return value != nullptr ? value->value : -1;
+}
+
+void remove_then_emplace()
+{
+    entt::registry registry;
+    auto entity = registry.create();
+    registry.emplace<Value>(entity, 1);
+
+    CommandBuffer buffer;
+    buffer.remove<Value>(entity);
+    buffer.emplace(entity, Value{2});
+    buffer.apply(registry);
+
+    check(value_of(registry, entity) == 2, "remove then emplace keeps the emplaced component");
+}
+
+void emplace_then_remove()
+{
+    entt::registry registry;
+    auto entity = registry.create();
+
+    CommandBuffer buffer;
+    buffer.emplace(entity, Value{1});
+    buffer.remove<Value>(entity);
+    buffer.apply(registry);
+
+    check(!registry.all_of<Value>(entity), "emplace then remove leaves no component");
+}
+
+void order_across_queued_buffers()
+{
+    entt::registry registry;
+    auto entity = registry.create();
+    registry.emplace<Value>(entity, 1);
+
+    CommandQueue queue;
+    auto first = queue.reserve();
+    auto second = queue.reserve();
+
+    CommandBuffer replacing;
+    replacing.emplace_or_replace(entity, Value{3});
+    queue.submit(second, std::move(replacing));
+
+    CommandBuffer removing;
+    removing.remove<Value>(entity);
+    queue.submit(first, std::move(removing));
+
+    queue.apply(registry);
+
+    check(value_of(registry, entity) == 3, "a later buffer's replace is not undone by a remove");
+}
+
+void bulk_insert_of_created_entities()
+{
+    entt::registry registry;
+
+    CommandBuffer first;
+    auto a = first.create();
+    first.emplace(a, Value{1});
+
+    CommandBuffer second;
+    auto b = second.create();
+    second.emplace(b, Value{2});
+    second.destroy(b);
+
+    first.append(std::move(second));
+    auto created = first.apply(registry);
+
+    check(created.size() == 2, "appended buffers create all entities");
+    check(value_of(registry, created.at(0)) == 1, "created entities receive their components");
+    check(!registry.valid(created.at(1)), "created entities can be destroyed");
+}
+
+} // namespace
+
+auto main() -> int
+{
+    remove_then_emplace();
+    emplace_then_remove();
+    order_across_queued_buffers();
+    bulk_insert_of_created_entities();
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,24 @@
+#version 430 core
+
+// G-buffer layout, see GBuffer.
+layout(location = 0) out vec4 g_albedo;
+layout(location = 1) out vec4 g_normal;
+layout(location = 2) out vec4 g_material;
+
+in vec2 v_texCoord;
+in mat3 v_TBN;
+
+layout(binding = 0) uniform sampler2D u_baseColorTexture;
+layout(binding = 1) uniform sampler2D u_normalMapTexture;
+
+void main()
+{
+    vec3 normal = texture(u_normalMapTexture, v_texCoord).rgb;
+    normal = normalize(v_TBN * (normal * 2.0 - 1.0));
+
+    g_albedo = vec4(texture(u_baseColorTexture, v_texCoord).rgb, 1.0f);
+    g_normal = vec4(normal, 0.0f);
+
+    // r: specular intensity
+    g_material = vec4(1.0f, 0.0f, 0.0f, 0.0f);
+}
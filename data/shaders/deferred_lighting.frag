@@ -0,0 +1,35 @@
+#version 430 core
+
+#include "view.glsl"
+#include "lighting.glsl"
+
+layout(location = 0) out vec4 f_color;
+
+in vec2 v_tex_coords;
+
+layout(binding = 0) uniform sampler2D u_gAlbedo;
+layout(binding = 1) uniform sampler2D u_gNormal;
+layout(binding = 2) uniform sampler2D u_gMaterial;
+layout(binding = 3) uniform sampler2D u_gDepth;
+
+void main()
+{
+    float depth = texture(u_gDepth, v_tex_coords).r;
+
+    // Nothing was drawn to this pixel.
+    if (depth == 1.0f)
+        discard;
+
+    // Reconstruct the position from the depth buffer.
+    vec4 ndc = vec4(v_tex_coords * 2.0f - 1.0f, depth * 2.0f - 1.0f, 1.0f);
+    vec4 viewPosition = u_inverseProjectionMatrix * ndc;
+    viewPosition /= viewPosition.w;
+
+    Surface surface;
+    surface.position = vec3(u_inverseViewMatrix * viewPosition);
+    surface.normal = normalize(texture(u_gNormal, v_tex_coords).xyz);
+    surface.albedo = texture(u_gAlbedo, v_tex_coords).rgb;
+    surface.specular = texture(u_gMaterial, v_tex_coords).r;
+
+    f_color = vec4(computeLighting(surface, ndc.xy, -viewPosition.z), 1.0f);
+}
@@ -0,0 +1,187 @@
+// Clustered lighting shared by the forward and the deferred path. Requires view.glsl.
+
+layout(std140, binding = 1) uniform LightBuffer
+{
+    vec4 u_directionalLightDirection; // w: 1 if the light is active
+    vec4 u_directionalLightColor;
+    uvec4 u_clusterCount;             // xyz: dimensions of the cluster grid, w: point light count
+    vec4 u_clusterDepthParams;        // x: scale, y: bias of the logarithmic depth slicing
+};
+
+struct PointLight
+{
+    vec4 positionRadius;
+    vec4 color;
+};
+
+layout(std430, binding = 1) readonly buffer PointLightBuffer
+{
+    PointLight u_pointLights[];
+};
+
+// Offset into u_lightIndices and number of lights per cluster.
+layout(std430, binding = 2) readonly buffer ClusterBuffer
+{
+    uvec2 u_clusters[];
+};
+
+layout(std430, binding = 3) readonly buffer LightIndexBuffer
+{
+    uint u_lightIndices[];
+};
+
+// Cascaded shadow maps of the directional light.
+layout(std140, binding = 2) uniform ShadowBuffer
+{
+    mat4 u_cascadeViewProjectionMatrices[4];
+    vec4 u_cascadeSplits;     // view depth at which each cascade ends
+    vec4 u_cascadeTexelSizes; // world space size of a shadow map texel of each cascade
+    vec4 u_shadowParams;      // x: 1 if the shadow map is valid
+};
+
+layout(binding = 4) uniform sampler2DArrayShadow u_shadowMap;
+
+struct Surface
+{
+    vec3 position;
+    vec3 normal;
+    vec3 albedo;
+    float specular;
+};
+
+uint clusterIndex(vec2 ndc, float viewDepth);
+
+vec3 directionalLightContribution(Surface surface, vec3 viewDir, float viewDepth);
+float directionalShadow(Surface surface, float viewDepth);
+vec3 pointLightContribution(PointLight light, Surface surface, vec3 viewDir);
+
+void computeShading(vec3 light_ambient, vec3 light_diffuse, vec3 light_specular, vec3 lightDir, vec3 viewDir,
+                    Surface surface, out vec3 ambient, out vec3 diffuse, out vec3 specular);
+
+float computeAttenuation(vec3 lightPos, float radius, vec3 fragPos, float K_q);
+
+// Lights a surface at the given normalized device coordinates and view depth.
+vec3 computeLighting(Surface surface, vec2 ndc, float viewDepth)
+{
+    vec3 color = vec3(0.0f);
+
+    vec3 viewDir = normalize(u_viewPosition.xyz - surface.position);
+
+    color += directionalLightContribution(surface, viewDir, viewDepth);
+
+    // Only the point lights assigned to the cluster of the fragment can reach it.
+    uvec2 cluster = u_clusters[clusterIndex(ndc, viewDepth)];
+    for (uint i = 0; i < cluster.y; i++) {
+        PointLight light = u_pointLights[u_lightIndices[cluster.x + i]];
+        color += pointLightContribution(light, surface, viewDir);
+    }
+
+    return color;
+}
+
+uint clusterIndex(vec2 ndc, float viewDepth)
+{
+    vec2 tile = clamp(floor((ndc * 0.5f + 0.5f) * vec2(u_clusterCount.xy)),
+                      vec2(0.0f), vec2(u_clusterCount.xy - 1u));
+
+    float slice = floor(log(viewDepth) * u_clusterDepthParams.x + u_clusterDepthParams.y);
+    slice = clamp(slice, 0.0f, float(u_clusterCount.z - 1u));
+
+    return uint(tile.x) + uint(tile.y) * u_clusterCount.x + uint(slice) * u_clusterCount.x * u_clusterCount.y;
+}
+
+vec3 directionalLightContribution(Surface surface, vec3 viewDir, float viewDepth)
+{
+    // Only compute if light source is active
+    if (u_directionalLightDirection.w == 0.0f)
+        return vec3(0.0f);
+
+    vec3 lightDir = normalize(-u_directionalLightDirection.xyz);
+
+    vec3 diffuseColor = u_directionalLightColor.rgb;
+    vec3 specularColor = u_directionalLightColor.rgb * 0.5f;
+    vec3 ambientColor = u_directionalLightColor.rgb * 0.002f;
+
+    vec3 ambient, diffuse, specular;
+    computeShading(ambientColor, diffuseColor, specularColor, lightDir, viewDir, surface, ambient, diffuse, specular);
+
+    float shadow = directionalShadow(surface, viewDepth);
+
+    return ambient + (diffuse + specular) * shadow;
+}
+
+float directionalShadow(Surface surface, float viewDepth)
+{
+    if (u_shadowParams.x == 0.0f)
+        return 1.0f;
+
+    int cascade = 0;
+    while (cascade < 4 && viewDepth > u_cascadeSplits[cascade])
+        cascade++;
+
+    if (cascade == 4)
+        return 1.0f;
+
+    // Offsetting the position along the normal avoids self shadowing at grazing angles.
+    vec3 position = surface.position + surface.normal * u_cascadeTexelSizes[cascade] * 1.5f;
+    vec4 lightPosition = u_cascadeViewProjectionMatrices[cascade] * vec4(position, 1.0f);
+    vec3 coords = lightPosition.xyz / lightPosition.w * 0.5f + 0.5f;
+
+    // 3x3 percentage closer filtering on top of the bilinear comparison of the hardware.
+    vec2 texelSize = 1.0f / vec2(textureSize(u_shadowMap, 0).xy);
+    float shadow = 0.0f;
+    for (int x = -1; x <= 1; x++) {
+        for (int y = -1; y <= 1; y++) {
+            vec2 offset = vec2(x, y) * texelSize;
+            shadow += texture(u_shadowMap, vec4(coords.xy + offset, float(cascade), coords.z));
+        }
+    }
+
+    return shadow / 9.0f;
+}
+
+vec3 pointLightContribution(PointLight light, Surface surface, vec3 viewDir)
+{
+    vec3 lightPos = light.positionRadius.xyz;
+    vec3 lightDir = normalize(lightPos - surface.position);
+
+    vec3 diffuseColor = light.color.rgb;
+    vec3 specularColor = light.color.rgb * 0.5f;
+    vec3 ambientColor = light.color.rgb * 0.002f;
+
+    vec3 ambient, diffuse, specular;
+    computeShading(ambientColor, diffuseColor, specularColor, lightDir, viewDir, surface, ambient, diffuse, specular);
+
+    float attenuation = computeAttenuation(lightPos, light.positionRadius.w, surface.position, 0.032f);
+    ambient *= attenuation;
+    diffuse *= attenuation;
+    specular *= attenuation;
+
+    return ambient + diffuse + specular;
+}
+
+void computeShading(vec3 light_ambient, vec3 light_diffuse, vec3 light_specular, vec3 lightDir, vec3 viewDir,
+                    Surface surface, out vec3 ambient, out vec3 diffuse, out vec3 specular)
+{
+    // Diffuse shading
+    float diffuseShading = max(dot(surface.normal, lightDir), 0.0f);
+
+    // Specular shading
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float specularShading = pow(max(dot(surface.normal, halfwayDir), 0.0f), 100.0f);
+
+    ambient = light_ambient * surface.albedo;
+    diffuse = light_diffuse * diffuseShading * surface.albedo;
+    specular = light_specular * specularShading * surface.specular;
+}
+
+float computeAttenuation(vec3 lightPos, float radius, vec3 fragPos, float K_q)
+{
+    float distanceLightFragment = length(lightPos - fragPos);
+
+    // Fade out towards the radius the light was culled with, to hide the cluster boundaries.
+    float falloff = distanceLightFragment / radius;
+    float window = clamp(1.0f - falloff * falloff * falloff * falloff, 0.0f, 1.0f);
+
+    return window * window / (K_q * distanceLightFragment * distanceLightFragment);
+}
@@ -0,0 +1,6 @@
+#version 430 core
+
+// Only the depth is written.
+void main()
+{
+}
@@ -0,0 +1,22 @@
+#version 430 core
+
+layout(location = 0) in vec3 a_position;
+// Per-instance attribute: base instance of the draw plus the instance index.
+layout(location = 4) in uint a_drawId;
+
+struct DrawData
+{
+    mat4 modelMatrix;
+};
+
+layout(std430, binding = 0) readonly buffer DrawDataBuffer
+{
+    DrawData u_drawData[];
+};
+
+uniform mat4 u_lightViewProjectionMatrix;
+
+void main()
+{
+    gl_Position = u_lightViewProjectionMatrix * u_drawData[a_drawId].modelMatrix * vec4(a_position, 1.0f);
+}
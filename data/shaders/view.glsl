@@ -0,0 +1,9 @@
+layout(std140, binding = 0) uniform ViewBuffer
+{
+    mat4 u_viewMatrix;
+    mat4 u_projectionMatrix;
+    mat4 u_viewProjectionMatrix;
+    mat4 u_inverseViewMatrix;
+    mat4 u_inverseProjectionMatrix;
+    vec4 u_viewPosition;
+};
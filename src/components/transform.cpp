@@ -1,6 +1,14 @@
 #include "transform.h"
+#include "core/command_buffer.h"
+#include "core/jobs.h"
 #include "relationship.h"
 
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+// Hierarchies per job
+static constexpr std::size_t ROOT_GRAIN = 256;
+
 void GlobalTransform::update(entt::registry &registry)
 {
     // Update GlobalTransform components
@@ -9,29 +17,80 @@ void GlobalTransform::update(entt::registry &registry)
         registry.view<Transform const, GlobalTransform>(entt::exclude<Parent>);
     auto transform_view = registry.view<Transform const, GlobalTransform, Parent const>();
 
-    for (auto [entity, transform, global_transform] : root_transform_view.each()) {
-        global_transform = transform;
-
-        auto parent_global_transform = global_transform;
-        if (auto *children = registry.try_get<Children>(entity)) {
-            for (auto child : children->children) {
-                std::function<void(entt::entity entity, GlobalTransform parent_global_transform)>
-                    transform_propagate =
-                        [&registry, &transform_propagate, &transform_view](
-                            entt::entity entity, GlobalTransform parent_global_transform) {
-                            auto [transform, global_transform, parent] = transform_view.get(entity);
-                            global_transform.transform = parent_global_transform.transform *
-                                                         GlobalTransform(transform).transform;
-
-                            if (auto *children = registry.try_get<Children>(entity)) {
-                                for (auto child : children->children) {
-                                    transform_propagate(child, global_transform);
+    // Hierarchies are independent of each other and propagated in parallel. Jobs only read the
+    // const registry, which never creates storage.
+    entt::registry const &const_registry = registry;
+    std::vector<entt::entity> roots;
+    for (auto entity : root_transform_view) {
+        roots.push_back(entity);
+    }
+
+    Jobs::parallel_for(0, roots.size(), ROOT_GRAIN, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            auto entity = roots[i];
+            auto [transform, global_transform] = root_transform_view.get(entity);
+            global_transform = transform;
+
+            auto parent_global_transform = global_transform;
+            if (auto const *children = const_registry.try_get<Children>(entity)) {
+                for (auto child : children->children) {
+                    std::function<void(entt::entity entity,
+                                       GlobalTransform parent_global_transform)>
+                        transform_propagate =
+                            [&const_registry, &transform_propagate, &transform_view](
+                                entt::entity entity, GlobalTransform parent_global_transform) {
+                                auto [transform, global_transform, parent] =
+                                    transform_view.get(entity);
+                                global_transform.transform = parent_global_transform.transform *
+                                                             GlobalTransform(transform).transform;
+
+                                if (auto const *children =
+                                        const_registry.try_get<Children>(entity)) {
+                                    for (auto child : children->children) {
+                                        transform_propagate(child, global_transform);
+                                    }
                                 }
-                            }
-                        };
+                            };
 
-                transform_propagate(child, parent_global_transform);
+                    transform_propagate(child, parent_global_transform);
+                }
             }
         }
+    });
+}
+
+auto GlobalTransform::interpolate(GlobalTransform const &previous,
+                                  GlobalTransform const &current,
+                                  float alpha) -> GlobalTransform
+{
+    auto decompose = [](glm::mat4 const &matrix) -> Transform {
+        auto const scale = glm::vec3(glm::length(glm::vec3(matrix[0])),
+                                     glm::length(glm::vec3(matrix[1])),
+                                     glm::length(glm::vec3(matrix[2])));
+        auto const rotation = glm::mat3(glm::vec3(matrix[0]) / scale.x,
+                                        glm::vec3(matrix[1]) / scale.y,
+                                        glm::vec3(matrix[2]) / scale.z);
+        return Transform{.translation = glm::vec3(matrix[3]),
+                         .orientation = glm::quat_cast(rotation),
+                         .scale = scale};
+    };
+
+    auto from = decompose(previous.transform);
+    auto to = decompose(current.transform);
+
+    return {Transform{.translation = glm::mix(from.translation, to.translation, alpha),
+                      .orientation = glm::slerp(from.orientation, to.orientation, alpha),
+                      .scale = glm::mix(from.scale, to.scale, alpha)}};
+}
+
+void PreviousGlobalTransform::store(entt::registry &registry, CommandBuffer &commands)
+{
+    auto view = registry.view<GlobalTransform const, Interpolated const>();
+    for (auto [entity, global_transform] : view.each()) {
+        if (auto *previous = registry.try_get<PreviousGlobalTransform>(entity)) {
+            previous->transform = global_transform.transform;
+        } else {
+            commands.emplace(entity, PreviousGlobalTransform{global_transform.transform});
+        }
     }
 }
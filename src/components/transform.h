@@ -6,6 +6,8 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/quaternion.hpp>
 
+class CommandBuffer;
+
 struct Transform
 {
     glm::vec3 translation{};
@@ -37,5 +39,26 @@ struct GlobalTransform
 
     [[nodiscard]] auto position() const -> glm::vec3 { return transform[3]; };
 
+    // Interpolates translation, orientation and scale separately, so rotations keep their scale.
+    // Shear of non-uniformly scaled parents is lost.
+    [[nodiscard]] static auto interpolate(GlobalTransform const &previous,
+                                          GlobalTransform const &current,
+                                          float alpha) -> GlobalTransform;
+
     static void update(entt::registry &registry);
 };
+
+// Marks entities moved by fixed-step systems, which are rendered interpolated between their last
+// two steps.
+struct Interpolated
+{
+};
+
+// GlobalTransform of an interpolated entity before the last fixed step
+struct PreviousGlobalTransform
+{
+    glm::mat4 transform{};
+
+    // Entities missing the component receive it through the command buffer.
+    static void store(entt::registry &registry, CommandBuffer &commands);
+};
@@ -1,14 +1,29 @@
 #include "application.h"
 
+#include "components/relationship.h"
+#include "components/transform.h"
 #include "core/camera.h"
+#include "core/command_buffer.h"
+#include "core/dynamic_resolution.h"
+#include "core/frame_limiter.h"
+#include "core/graphics/geometry_pool.h"
+#include "core/graphics/gl_queue.h"
+#include "core/graphics/gpu_profiler.h"
+#include "core/graphics/gl_state.h"
+#include "core/graphics/texture_pool.h"
+#include "core/jobs.h"
 #include "core/light.h"
 #include "core/render.h"
 #include "core/shader.h"
+#include "core/shadows.h"
 #include "core/time.h"
 #include "input/input.h"
+#include "util/profiler.h"
 #include "window/window.h"
 
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <fstream>
 #include <fx/gltf.h>
 #include <glad/gl.h>
 #include <glm/glm.hpp>
@@ -17,11 +32,18 @@
 
 namespace FeverCore {
 
-Application::~Application() = default;
+Application::~Application()
+{
+    Jobs::stop();
+
+    // Work of the loader jobs that no frame picked up anymore
+    GlQueue::execute();
+}
 
-Application::Application() :
-    game_window(std::make_shared<Window>(event_dispatcher)),
-    post_processing_framebuffer(game_window->physical_dimensions()),
+Application::Application(Options const& options) :
+    game_window(std::make_shared<Window>(
+        event_dispatcher,
+        Window::Options{.headless = options.headless, .dimensions = options.dimensions})),
     key_listener{.registry = entt_registry},
     cursor_listener{.registry = entt_registry},
     gltf_loader{.image_cache = image_cache,
@@ -30,11 +52,27 @@ Application::Application() :
                 .shader_cache = shader_cache,
                 .gltf_mesh_cache = gltf_mesh_cache,
                 .gltf_node_cache = gltf_node_cache},
-    gltf_cache(gltf_loader)
+    gltf_cache(gltf_loader),
+    options(options),
+    target_dimensions(game_window->physical_dimensions())
 {
+    // The thread creating the window becomes the main thread of the pool. It owns the GL context
+    // until the game loop hands it over to the render thread.
+    Jobs::start();
     register_context_variables();
+    register_systems();
+
+    if (options.record_path.has_value()) {
+        recorder.emplace(event_dispatcher);
+    }
+
+    if (options.replay_path.has_value()) {
+        replay = Replay::load(options.replay_path.value());
+    }
 
-    event_dispatcher.sink<Window::ResizeEvent>().connect<&Application::recreate_framebuffer>(this);
+    event_dispatcher.sink<Window::ResizeEvent>().connect<&Application::on_resize>(this);
+    event_dispatcher.sink<Input::KeyInput>().connect<&Application::on_input>(this);
+    event_dispatcher.sink<Input::MouseMotion>().connect<&Application::on_input>(this);
     event_dispatcher.sink<Input::KeyInput>().connect<&Input::KeyListener::key_event>(key_listener);
     event_dispatcher.sink<Input::MouseMotion>().connect<&Input::CursorListener::cursor_event>(
         cursor_listener);
@@ -42,61 +80,526 @@ Application::Application() :
 
 void Application::run()
 {
-    entt::hashed_string shader_hash(Material::SHADER_NAME.data());
-    auto standard_material_shader =
-        shader_cache.load(shader_hash, Material::SHADER_NAME).first->second;
-
     spdlog::info("Startup complete. Enter game loop.");
+    FEVER_PROFILE_THREAD("main");
+
+    if (options.headless || options.capture_interval != 0) {
+        std::filesystem::create_directories(options.output_directory);
+        frame_capture.emplace(
+            FrameCapture::Options{.format = options.capture_format,
+                                  .output_directory = options.output_directory,
+                                  .reference_directory = options.reference_directory});
+    }
+
+    Jobs::reset_stats();
+    scheduler.reset_timings();
+
+    std::optional<FrameLimiter> frame_limiter;
+    if (options.target_fps > 0.0) {
+        frame_limiter.emplace(options.target_fps);
+    }
+
+    bool const on_demand = options.on_demand && !options.headless;
+    std::optional<std::uint64_t> rendered_fingerprint;
+    std::uint64_t last_change = 0;
+
+    // Copied before the render thread starts, which owns the render registry from then on.
+    auto const update_intervals = render_registry.ctx().get<Shadows::Settings>().update_intervals;
+    std::uint64_t const settle_frames =
+        std::max(*std::max_element(update_intervals.cbegin(), update_intervals.cend()), 1U);
+
+    std::uint64_t skipped_frames = 0;
+    bool idle = false;
+
+    RenderSnapshot inline_snapshot;
+    if (options.render_thread) {
+        render_thread.emplace(game_window->handle(), [this](RenderSnapshot const& snapshot) {
+            render_snapshot(snapshot);
+        });
+    }
 
     // This is the game loop
-    while (glfwWindowShouldClose(&game_window->handle()) == GLFW_FALSE) {
+    for (std::uint64_t frame = 0; glfwWindowShouldClose(&game_window->handle()) == GLFW_FALSE;
+         ++frame) {
+        if ((options.headless && frame == options.frame_count) ||
+            (replay.has_value() && frame == replay->frames.size())) {
+            break;
+        }
+
+        FEVER_PROFILE_ZONE("frame");
+        auto const frame_start = std::chrono::steady_clock::now();
+
         // --- Timing ---
         Time::update_delta_time(entt_registry);
 
+        // Headless runs take exactly one fixed step per frame, so that a frame always shows the
+        // same simulation state. Replays override the delta with the recorded one instead.
+        if (options.headless && !replay.has_value()) {
+            Time::set_delta_time(entt_registry, entt_registry.ctx().get<Time::FixedStep>().step);
+        }
+
         // --- Check events, handle input ---
-        glfwPollEvents();
+        {
+            FEVER_PROFILE_ZONE("poll_events");
+            if (idle) {
+                glfwWaitEventsTimeout(IDLE_WAIT_TIME.count());
+            } else {
+                glfwPollEvents();
+            }
+        }
+
+        if (replay.has_value()) {
+            replay_frame(frame);
+        }
+
+        Jobs::run_main_thread_jobs();
 
         // --- Update game state ---
-        event_dispatcher.update();
+        {
+            FEVER_PROFILE_ZONE("dispatch_events");
+            event_dispatcher.update();
+        }
+
+        if (recorder.has_value()) {
+            recorder->end_frame(entt_registry.ctx().get<Time::Delta>().delta);
+        }
+
+        // Sync point of the background loaders
+        entt_registry.ctx().get<CommandQueue>().apply(entt_registry);
+
+        scheduler.run(entt_registry, Time::advance_fixed_step(entt_registry));
+        update_target_dimensions();
+
+        // --- Extract the render data, render and buffer swap ---
+        // Waiting for the render thread is not part of the simulation time.
+        std::chrono::duration<float, std::milli> simulation_time =
+            std::chrono::steady_clock::now() - frame_start;
+
+        auto& snapshot = render_thread.has_value() ? render_thread->acquire() : inline_snapshot;
+        {
+            FEVER_PROFILE_ZONE("extract");
+            auto const extract_start = std::chrono::steady_clock::now();
+            snapshot.extract(entt_registry, entt_registry.ctx().get<Time::FixedStep>().alpha);
+            simulation_time += std::chrono::steady_clock::now() - extract_start;
+        }
+
+        bool const last = options.headless && frame + 1 == options.frame_count;
+        snapshot.frame = frame;
+        snapshot.simulation_time = simulation_time;
+        snapshot.window_dimensions = game_window->physical_dimensions();
+        snapshot.target_dimensions = target_dimensions;
+        snapshot.capture =
+            frame_capture.has_value() &&
+            (last || (options.capture_interval != 0 && frame % options.capture_interval == 0));
+
+        bool render = true;
+        if (on_demand) {
+            auto const fingerprint = snapshot.fingerprint();
+            bool const changed =
+                input_arrived || snapshot.capture || fingerprint != rendered_fingerprint;
+            if (changed) {
+                rendered_fingerprint = fingerprint;
+                last_change = frame;
+            }
 
-        game_window->update_descriptor(entt_registry);
-        game_window->mouse_catching(entt_registry);
-        game_window->close_on_esc(entt_registry);
+            // After a change, every frame is rendered until one at least as many frames later as
+            // the slowest cascade update interval postponed no cascade. By then every cascade
+            // was updated since the change, and the resolution scale has settled as well.
+            render = changed || settled_frames.load(std::memory_order_acquire) <
+                                    last_change + settle_frames;
+        }
+        input_arrived = false;
+        idle = on_demand && !render;
 
-        GlobalTransform::update(entt_registry);
-        Camera::aspect_ratio_update(entt_registry);
+        if (!render) {
+            // The snapshot is left to be refilled by the next frame.
+            ++skipped_frames;
+        } else if (render_thread.has_value()) {
+            render_thread->submit();
+        } else {
+            render_snapshot(snapshot);
+        }
 
-        this->update();
+        if (frame_limiter.has_value()) {
+            FEVER_PROFILE_ZONE("frame_limiter");
+            frame_limiter->wait();
+        }
+    }
+
+    if (on_demand) {
+        spdlog::info("Skipped rendering {} unchanged frames", skipped_frames);
+    }
+
+    if (auto const& fixed_step = entt_registry.ctx().get<Time::FixedStep>();
+        fixed_step.dropped_steps != 0) {
+        spdlog::warn("Dropped {} of {} fixed steps, frames took longer than {} steps",
+                     fixed_step.dropped_steps,
+                     fixed_step.steps + fixed_step.dropped_steps,
+                     fixed_step.max_steps);
+    }
+
+    // Renders the last frame and returns the GL context
+    render_thread.reset();
+    GlQueue::execute();
+
+    if (frame_capture.has_value()) {
+        auto summary = frame_capture->finish();
+        spdlog::info(
+            "Captured {} frames into {}", summary.written, options.output_directory.string());
+
+        if (summary.mismatched != 0) {
+            spdlog::error("{} captured frames differ from their reference", summary.mismatched);
+            status = 1;
+        }
+
+        if (summary.failed != 0) {
+            spdlog::error("{} frames could not be captured", summary.failed);
+            status = 1;
+        }
+    }
+
+    if (options.headless) {
+        write_frame_timings();
+    }
+
+    if (options.benchmark_path.has_value()) {
+        write_benchmark();
+    }
+
+    if (measuring()) {
+        auto const worker_stats = Jobs::stats();
+        for (std::size_t i = 0; i < worker_stats.size(); ++i) {
+            spdlog::info("Job thread {}: {} jobs, {} stolen, {:.1f}% busy",
+                         i,
+                         worker_stats[i].jobs,
+                         worker_stats[i].steals,
+                         worker_stats[i].utilization * 100.0F);
+        }
 
-        Input::State<Input::KeyCode>::update_state(entt_registry);
-        Input::reset_mouse_motion(entt_registry);
+        for (auto const& timing : scheduler.timings()) {
+            spdlog::info("System {}: {:.3f} ms", timing.name, timing.average_milliseconds);
+        }
+    }
+
+    if (recorder.has_value()) {
+        Replay::save(options.record_path.value(), recorder->recording());
+    }
+
+#ifdef FEVER_PROFILING
+    Profiler::write_chrome_trace("fever_trace.json");
+#endif
+}
+
+void Application::render_snapshot(RenderSnapshot const& snapshot)
+{
+    FEVER_PROFILE_ZONE("render");
+    auto const render_start = std::chrono::steady_clock::now();
 
-        // --- Render and buffer swap ---
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // Uploads and releases of the main thread, before the snapshot draws what they uploaded
+    GlQueue::execute();
 
-        post_processing_framebuffer.bind();
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    GlState::reset_stats();
+    snapshot.apply(render_registry);
 
-        Light::update_lights(entt_registry, standard_material_shader);
-        Render::render(entt_registry);
+    render_registry.ctx().get<Render::Viewport>().dimensions =
+        DynamicResolution::scaled(render_registry, snapshot.target_dimensions);
+    render_frame(snapshot);
 
-        Framebuffer::unbind();
-        post_processing_framebuffer.draw(post_processing_shader);
+    if (render_registry.ctx().get<Shadows::Stats>().cascades_postponed == 0 &&
+        render_registry.ctx().get<DynamicResolution::State>().settled) {
+        settled_frames.store(snapshot.frame + 1, std::memory_order_release);
+    }
 
+    if (frame_capture.has_value()) {
+        frame_capture->poll();
+    }
+
+    {
+        FEVER_PROFILE_ZONE("swap");
         glfwSwapBuffers(&game_window->handle());
     }
+
+    if (measuring()) {
+        record_sample(snapshot, render_start);
+    }
 }
 
 void Application::register_context_variables()
 {
     entt_registry.ctx().emplace<Input::State<Input::KeyCode>>();
     entt_registry.ctx().emplace<Input::MouseMotion>();
+    entt_registry.ctx().emplace<CommandQueue>();
+    entt_registry.ctx().emplace<Time::FixedStep>().step =
+        std::chrono::duration<double>(1.0 / options.fixed_rate);
+    entt_registry.ctx().emplace<GeometryUploader>(render_registry);
+    entt_registry.ctx().emplace<Window::MouseCatched>(Window::MouseCatched{.catched = false});
+    game_window->update_descriptor(entt_registry);
+
+    render_registry.ctx().emplace<GpuProfiler>();
+    render_registry.ctx().emplace<TexturePool>();
+    render_registry.ctx().emplace<GeometryPool>();
+    render_registry.ctx().emplace<Render::Settings>();
+    render_registry.ctx().emplace<Render::Stats>();
+    render_registry.ctx().emplace<Render::Viewport>(
+        Render::Viewport{.dimensions = game_window->physical_dimensions()});
+    render_registry.ctx().emplace<Shadows::Settings>();
+    render_registry.ctx().emplace<DynamicResolution::Settings>();
+    render_registry.ctx().emplace<DynamicResolution::State>();
+    render_registry.ctx().emplace<Shadows::Stats>();
+}
+
+void Application::register_systems()
+{
+    using Stage = Scheduler::Stage;
+    using Access = Scheduler::Access;
+    using KeyState = Input::State<Input::KeyCode>;
+
+    scheduler.set_validation(options.validate_systems);
+
+    scheduler.add(Stage::PreUpdate,
+                  "update_descriptor",
+                  Access{}.write_context<Window::Descriptor>().main_thread(),
+                  [this](entt::registry& registry) { game_window->update_descriptor(registry); });
+    scheduler.add(Stage::PreUpdate,
+                  "mouse_catching",
+                  Access{}
+                      .read_context<KeyState>()
+                      .write_context<Window::MouseCatched>()
+                      .main_thread(),
+                  [this](entt::registry& registry) { game_window->mouse_catching(registry); });
+    scheduler.add(Stage::PreUpdate,
+                  "close_on_esc",
+                  Access{}.read_context<KeyState>().main_thread(),
+                  [this](entt::registry& registry) { game_window->close_on_esc(registry); });
+
+    // Interpolated entities remember where they were before the step, and their transforms are
+    // propagated after it, so rendering can interpolate between the last two steps.
+    scheduler.add(Stage::FixedUpdate,
+                  "store_previous_transforms",
+                  Access{}
+                      .read<GlobalTransform>()
+                      .read<Interpolated>()
+                      .write<PreviousGlobalTransform>(),
+                  &PreviousGlobalTransform::store);
+    scheduler.add(Stage::FixedPostUpdate,
+                  "fixed_global_transform",
+                  Access{}
+                      .read<Transform>()
+                      .read<Parent>()
+                      .read<Children>()
+                      .write<GlobalTransform>(),
+                  &GlobalTransform::update);
+
+    scheduler.add(Stage::Update,
+                  "global_transform",
+                  Access{}
+                      .read<Transform>()
+                      .read<Parent>()
+                      .read<Children>()
+                      .write<GlobalTransform>(),
+                  &GlobalTransform::update);
+    scheduler.add(Stage::Update,
+                  "aspect_ratio_update",
+                  Access{}.read_context<Window::Descriptor>().write<Camera>(),
+                  &Camera::aspect_ratio_update);
+
+    // Applications are free to touch anything in update()
+    scheduler.add(Stage::Update,
+                  "update",
+                  Access{}.exclusive().main_thread(),
+                  [this](entt::registry&) { update(); });
+
+    scheduler.add(Stage::PostUpdate,
+                  "update_key_state",
+                  Access{}.write_context<KeyState>(),
+                  &KeyState::update_state);
+    scheduler.add(Stage::PostUpdate,
+                  "reset_mouse_motion",
+                  Access{}.write_context<Input::MouseMotion>(),
+                  &Input::reset_mouse_motion);
+}
+
+void Application::on_resize()
+{
+    // Dragging a window border emits a storm of resize events. Render targets are only resized
+    // once the size settled, until then the last frame size is scaled to the window.
+    last_resize = std::chrono::steady_clock::now();
+}
+
+void Application::on_input()
+{
+    input_arrived = true;
+}
+
+void Application::update_target_dimensions()
+{
+    if (last_resize.has_value() &&
+        std::chrono::steady_clock::now() - last_resize.value() >= RESIZE_SETTLE_TIME) {
+        last_resize.reset();
+
+        // A minimized window has no size, the targets keep their size until it is restored.
+        auto dimensions = game_window->physical_dimensions();
+        if (dimensions.x != 0 && dimensions.y != 0) {
+            target_dimensions = dimensions;
+        }
+    }
+}
+
+void Application::replay_frame(std::uint64_t frame)
+{
+    // Live input is dropped, the replay alone drives the game.
+    event_dispatcher.clear<Input::KeyInput>();
+    event_dispatcher.clear<Input::MouseMotion>();
+
+    auto const& recorded = replay->frames.at(frame);
+    Time::set_delta_time(entt_registry, recorded.delta);
+
+    for (auto const& key_input : recorded.key_inputs) {
+        event_dispatcher.enqueue(key_input);
+    }
+    event_dispatcher.enqueue(Input::MouseMotion{.delta = recorded.mouse_delta});
+}
+
+void Application::record_sample(RenderSnapshot const& snapshot,
+                                std::chrono::steady_clock::time_point render_start)
+{
+    // Simulation and rendering overlap, the slower of both sets the frame rate.
+    std::chrono::duration<float, std::milli> render_time =
+        std::chrono::steady_clock::now() - render_start;
+    float const cpu_milliseconds =
+        render_thread.has_value()
+            ? std::max(snapshot.simulation_time.count(), render_time.count())
+            : snapshot.simulation_time.count() + render_time.count();
+
+    auto const& render_stats = render_registry.ctx().get<Render::Stats>();
+    auto const& shadow_stats = render_registry.ctx().get<Shadows::Stats>();
+
+    samples.push_back(
+        Benchmark::Sample{.cpu_milliseconds = cpu_milliseconds,
+                          .draw_calls = render_stats.draw_calls + shadow_stats.draw_calls,
+                          .triangles = render_stats.triangles + shadow_stats.triangles});
+
+    // GPU times arrive a few frames late
+    auto const& latest = render_registry.ctx().get<GpuProfiler>().latest();
+    if (!latest.timings.empty() && latest.frame < samples.size()) {
+        samples[latest.frame].gpu_milliseconds = latest.milliseconds;
+    }
+}
+
+auto Application::measuring() const -> bool
+{
+    return options.headless || options.benchmark_path.has_value();
+}
+
+void Application::write_benchmark()
+{
+    auto report = Benchmark::report(samples);
+
+    if (options.baseline_path.has_value()) {
+        auto baseline = Benchmark::load(options.baseline_path.value());
+        if (!baseline.has_value()) {
+            spdlog::error("Benchmark could not be compared to its baseline");
+            status = 1;
+        } else if (!Benchmark::compare(report, baseline.value(), options.baseline_tolerance)) {
+            status = 1;
+        }
+    }
+
+    Benchmark::save(options.benchmark_path.value(), report);
+}
+
+void Application::write_frame_timings() const
+{
+    auto path = options.output_directory / "timings.csv";
+    std::ofstream file(path);
+    if (!file) {
+        spdlog::error(R"(Could not write frame timings "{}")", path.string());
+        return;
+    }
+
+    file << "frame,cpu_ms,gpu_ms\n";
+    for (std::size_t frame = 0; frame < samples.size(); ++frame) {
+        auto const& sample = samples[frame];
+
+        file << frame << ',' << sample.cpu_milliseconds << ',';
+        if (sample.gpu_milliseconds.has_value()) {
+            file << sample.gpu_milliseconds.value();
+        }
+        file << '\n';
+    }
+
+    spdlog::info("Wrote {} frame timings to {}", samples.size(), path.string());
 }
 
-void Application::recreate_framebuffer()
+void Application::render_frame(RenderSnapshot const& snapshot)
 {
-    auto dimensions = game_window->physical_dimensions();
-    post_processing_framebuffer = Framebuffer(dimensions);
+    auto dimensions = render_registry.ctx().get<Render::Viewport>().dimensions;
+    auto window_dimensions = snapshot.window_dimensions;
+
+    auto& profiler = render_registry.ctx().get<GpuProfiler>();
+    profiler.begin_frame();
+
+    RenderGraph::TextureHandle scene_color{};
+
+    render_graph.add_pass(
+        "shadows",
+        [](RenderGraph::PassBuilder& builder) { builder.side_effect(); },
+        [this](RenderGraph::PassContext const&) { Shadows::render(render_registry); });
+
+    render_graph.add_pass(
+        "scene",
+        [&](RenderGraph::PassBuilder& builder) {
+            scene_color = builder.create(
+                TextureDescription{.dimensions = dimensions, .internal_format = GL_RGBA16F});
+            builder.create(TextureDescription{.dimensions = dimensions,
+                                              .internal_format = GL_DEPTH24_STENCIL8});
+        },
+        [this, &profiler](RenderGraph::PassContext const&) {
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            {
+                FEVER_PROFILE_ZONE("light_update");
+                GpuProfiler::Scope scope(profiler, "light_update");
+                Light::update_lights(render_registry);
+            }
+
+            GpuProfiler::Scope scope(profiler, "draw");
+            Render::render(render_registry);
+        });
+
+    auto output =
+        post_processing.add_passes(render_graph, scene_color, dimensions, window_dimensions);
+
+    // Captures read the offscreen output, as the pixels of a hidden window are undefined. It is
+    // written rather than read so that the graph binds its framebuffer as the blit source.
+    render_graph.add_pass(
+        "present",
+        [&output](RenderGraph::PassBuilder& builder) {
+            output = builder.write(output);
+            builder.side_effect();
+        },
+        [this, &snapshot, window_dimensions](RenderGraph::PassContext const&) {
+            if (frame_capture.has_value() && snapshot.capture) {
+                frame_capture->capture(snapshot.frame, window_dimensions);
+            }
+
+            // Only the draw binding is changed, so it is restored to keep the cached
+            // framebuffer binding valid.
+            auto width = static_cast<GLint>(window_dimensions.x);
+            auto height = static_cast<GLint>(window_dimensions.y);
+
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            glBlitFramebuffer(
+                0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, GlState::framebuffer());
+        });
+
+    auto& texture_pool = render_registry.ctx().get<TexturePool>();
+    render_graph.execute(texture_pool, profiler);
+    texture_pool.end_frame();
+
+    profiler.end_frame();
+    DynamicResolution::update(render_registry);
 }
 
 } // namespace FeverCore
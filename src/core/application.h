@@ -1,15 +1,26 @@
 #pragma once
 
-#include "core/graphics/framebuffer.h"
+#include "core/benchmark.h"
+#include "core/graphics/frame_capture.h"
+#include "core/render_graph.h"
+#include "core/render_thread.h"
+#include "core/replay.h"
+#include "core/scheduler.h"
 #include "core/shader.h"
 #include "entt/entity/fwd.hpp"
 #include "entt/signal/fwd.hpp"
 #include "input/input.h"
+#include "post_processing/post_processing.h"
 #include "scene/gltf_loader.h"
 
+#include <atomic>
+#include <chrono>
 #include <entt/entt.hpp>
+#include <filesystem>
 #include <glm/glm.hpp>
 #include <memory>
+#include <optional>
+#include <vector>
 
 class Camera;
 class Window;
@@ -19,7 +30,53 @@ namespace FeverCore {
 class Application
 {
 public:
-    Application();
+    struct Options
+    {
+        // Runs frame_count frames without a visible window, capturing frames and writing frame
+        // timings into the output directory.
+        bool headless = false;
+        glm::u32vec2 dimensions{1280, 720};
+        unsigned frame_count = 300;
+
+        // Frames between two captured frames, 1 to capture every frame. 0 only captures the
+        // last frame of a headless run and nothing otherwise.
+        unsigned capture_interval = 0;
+        FrameCapture::Format capture_format = FrameCapture::Format::Png;
+        std::filesystem::path output_directory = "headless";
+
+        // Compares the captured frames against reference images, a mismatch fails the run.
+        std::optional<std::filesystem::path> reference_directory;
+
+        // Records the input and frame deltas of the session into this file.
+        std::optional<std::filesystem::path> record_path;
+
+        // Replays a recording instead of the live input and stops when it ends.
+        std::optional<std::filesystem::path> replay_path;
+
+        // Writes benchmark statistics of the run, compared to a baseline report if given.
+        std::optional<std::filesystem::path> benchmark_path;
+        std::optional<std::filesystem::path> baseline_path;
+        float baseline_tolerance = 0.1F;
+
+        // Runs the systems one after another, warning about undeclared component writes.
+        bool validate_systems = false;
+
+        // Steps per second of the fixed-rate simulation
+        double fixed_rate = 60.0;
+
+        // Renders on a dedicated thread while the next frame is simulated. Without it, every frame
+        // is simulated and rendered in turn.
+        bool render_thread = true;
+
+        // Limits the frame rate, 0 leaves it to the swap interval.
+        double target_fps = 0.0;
+
+        // Skips rendering and presenting frames that would look like the last one, and waits for
+        // input while nothing changes. Ignored by headless runs.
+        bool on_demand = false;
+    };
+
+    explicit Application(Options const& options);
 
     virtual ~Application();
     Application(Application const&) = delete;
@@ -35,19 +92,35 @@ public:
 
     void run();
 
+    // Non-zero if the benchmark regressed against its baseline or a captured frame differs from
+    // its reference.
+    [[nodiscard]] auto exit_code() const -> int { return status; }
+
     virtual void update() = 0;
 
 protected:
     virtual void register_context_variables();
-    void recreate_framebuffer();
+
+    // Systems of the game loop, applications add their own besides update().
+    Scheduler scheduler;
 
     std::shared_ptr<Window> game_window;
 
-    Shader post_processing_shader{"post_processing", "data/shaders"};
-    Framebuffer post_processing_framebuffer;
+    PostProcessing::Chain post_processing{{PostProcessing::bloom(1.0F, 0.5F),
+                                           PostProcessing::tone_map(1.0F),
+                                           PostProcessing::gamma_correction(2.2F),
+                                           PostProcessing::fxaa(),
+                                           PostProcessing::vignette(0.3F, 0.5F),
+                                           PostProcessing::dithering()}};
+
+    RenderGraph render_graph;
 
     entt::registry entt_registry;
 
+    // Entities of the snapshot currently rendered and the context variables of the renderer, only
+    // touched by the thread owning the GL context.
+    entt::registry render_registry;
+
     entt::dispatcher event_dispatcher{};
     Input::KeyListener key_listener;
     Input::CursorListener cursor_listener;
@@ -62,6 +135,53 @@ protected:
 
     GltfLoader gltf_loader;
     entt::resource_cache<Gltf, GltfLoader> gltf_cache;
+
+private:
+    // Time the size of the window has to stay the same before the render targets follow it.
+    static constexpr std::chrono::milliseconds RESIZE_SETTLE_TIME{100};
+
+    // Time an idle on-demand loop waits for events before it simulates the next frame.
+    static constexpr std::chrono::duration<double> IDLE_WAIT_TIME{0.1};
+
+    void register_systems();
+
+    void on_resize();
+    void on_input();
+    void update_target_dimensions();
+    void render_snapshot(RenderSnapshot const& snapshot);
+    void render_frame(RenderSnapshot const& snapshot);
+
+    void replay_frame(std::uint64_t frame);
+    void record_sample(RenderSnapshot const& snapshot,
+                       std::chrono::steady_clock::time_point render_start);
+    [[nodiscard]] auto measuring() const -> bool;
+    void write_frame_timings() const;
+    void write_benchmark();
+
+    Options options;
+
+    std::optional<std::chrono::steady_clock::time_point> last_resize;
+
+    // Input since the last frame, which an on-demand loop always renders.
+    bool input_arrived = false;
+
+    // One past the latest frame that was rendered without postponing shadow cascades and at a
+    // settled resolution scale. Written by the thread rendering, read by the on-demand loop.
+    std::atomic<std::uint64_t> settled_frames{};
+
+    // Settled size of the window, which the scene is rendered at before dynamic resolution.
+    glm::u32vec2 target_dimensions;
+
+    std::optional<FrameCapture> frame_capture;
+    std::optional<RenderThread> render_thread;
+
+    std::optional<Replay::Recorder> recorder;
+    std::optional<Replay::Recording> replay;
+
+    // Measurements of every frame of a headless or benchmark run
+    std::vector<Benchmark::Sample> samples;
+
+    int status = 0;
 };
 
 } // namespace FeverCore
@@ -0,0 +1,131 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <spdlog/spdlog.h>
+#include <string_view>
+#include <vector>
+
+namespace Benchmark {
+
+namespace {
+
+// Metrics compared to the baseline, as JSON pointers into a report
+constexpr std::array<std::string_view, 8> COMPARED_METRICS{
+    "/cpu_frame_time_ms/p50",
+    "/cpu_frame_time_ms/p95",
+    "/cpu_frame_time_ms/p99",
+    "/gpu_frame_time_ms/p50",
+    "/gpu_frame_time_ms/p95",
+    "/gpu_frame_time_ms/p99",
+    "/draw_calls/mean",
+    "/triangles/mean",
+};
+
+// Nearest-rank percentile
+auto percentile(std::vector<double> const& sorted, double percent) -> double
+{
+    auto rank = static_cast<std::size_t>(std::ceil(percent / 100.0 * sorted.size()));
+    return sorted.at(std::clamp<std::size_t>(rank, 1, sorted.size()) - 1);
+}
+
+auto distribution(std::vector<double> values) -> nlohmann::json
+{
+    if (values.empty()) {
+        return nullptr;
+    }
+
+    std::sort(values.begin(), values.end());
+    double mean = std::accumulate(values.cbegin(), values.cend(), 0.0) / values.size();
+
+    return {{"p50", percentile(values, 50.0)},
+            {"p95", percentile(values, 95.0)},
+            {"p99", percentile(values, 99.0)},
+            {"mean", mean},
+            {"max", values.back()}};
+}
+
+} // namespace
+
+auto report(std::span<Sample const> samples) -> nlohmann::json
+{
+    if (samples.size() > WARMUP_FRAMES * 2) {
+        samples = samples.subspan(WARMUP_FRAMES);
+    }
+
+    std::vector<double> cpu_times;
+    std::vector<double> gpu_times;
+    std::vector<double> draw_calls;
+    std::vector<double> triangles;
+
+    for (auto const& sample : samples) {
+        cpu_times.push_back(sample.cpu_milliseconds);
+        if (sample.gpu_milliseconds.has_value()) {
+            gpu_times.push_back(sample.gpu_milliseconds.value());
+        }
+        draw_calls.push_back(sample.draw_calls);
+        triangles.push_back(static_cast<double>(sample.triangles));
+    }
+
+    return {{"frames", samples.size()},
+            {"cpu_frame_time_ms", distribution(std::move(cpu_times))},
+            {"gpu_frame_time_ms", distribution(std::move(gpu_times))},
+            {"draw_calls", distribution(std::move(draw_calls))},
+            {"triangles", distribution(std::move(triangles))}};
+}
+
+auto compare(nlohmann::json& report, nlohmann::json const& baseline, float tolerance) -> bool
+{
+    auto regressions = nlohmann::json::array();
+
+    for (auto metric : COMPARED_METRICS) {
+        nlohmann::json::json_pointer const pointer{std::string(metric)};
+        if (!report.contains(pointer) || !baseline.contains(pointer) ||
+            !report[pointer].is_number() || !baseline[pointer].is_number()) {
+            continue;
+        }
+
+        double current = report[pointer];
+        double reference = baseline[pointer];
+        if (current > reference * (1.0 + tolerance)) {
+            spdlog::warn("{} regressed from {:.3f} to {:.3f}", metric, reference, current);
+            regressions.push_back(
+                {{"metric", metric}, {"baseline", reference}, {"current", current}});
+        }
+    }
+
+    bool const passed = regressions.empty();
+    report["baseline"] = {{"tolerance", tolerance}, {"regressions", std::move(regressions)}};
+
+    return passed;
+}
+
+auto load(std::filesystem::path const& path) -> std::optional<nlohmann::json>
+{
+    std::ifstream file(path);
+    auto json = nlohmann::json::parse(file, nullptr, false);
+    if (json.is_discarded() || !json.is_object()) {
+        spdlog::error(R"(Could not read benchmark "{}")", path.string());
+        return {};
+    }
+
+    return json;
+}
+
+auto save(std::filesystem::path const& path, nlohmann::json const& report) -> bool
+{
+    std::ofstream file(path);
+    if (!file) {
+        spdlog::error(R"(Could not write benchmark "{}")", path.string());
+        return false;
+    }
+
+    file << report.dump(4) << '\n';
+    spdlog::info(R"(Wrote benchmark "{}")", path.string());
+    return static_cast<bool>(file);
+}
+
+} // namespace Benchmark
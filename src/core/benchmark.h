@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <span>
+
+// Statistics of a run, e.g. a replayed recording, written as JSON and compared to an earlier
+// run as baseline.
+namespace Benchmark {
+
+// Frames at the start of a run that are left out of the statistics, as they include shader
+// compilation and uploads.
+static constexpr std::size_t WARMUP_FRAMES = 10;
+
+struct Sample
+{
+    float cpu_milliseconds;
+
+    // Arrives a few frames late and is missing for the last frames of a run
+    std::optional<float> gpu_milliseconds{};
+
+    unsigned draw_calls;
+    std::uint64_t triangles;
+};
+
+auto report(std::span<Sample const> samples) -> nlohmann::json;
+
+// Compares the frame time percentiles, draw calls and triangles of a report to a baseline
+// report and adds the metrics that grew by more than the tolerance to it. Returns whether
+// nothing regressed.
+auto compare(nlohmann::json& report, nlohmann::json const& baseline, float tolerance) -> bool;
+
+auto load(std::filesystem::path const& path) -> std::optional<nlohmann::json>;
+auto save(std::filesystem::path const& path, nlohmann::json const& report) -> bool;
+
+} // namespace Benchmark
@@ -0,0 +1,184 @@
+#include "cluster_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void ClusterGrid::set_projection(glm::mat4 const& projection, float near, float far)
+{
+    if (projection == this->projection && near == this->near && far == this->far) {
+        return;
+    }
+
+    this->projection = projection;
+    this->near = near;
+    this->far = far;
+
+    float const log_ratio = std::log(far / near);
+    scale = static_cast<float>(SLICES) / log_ratio;
+    bias = -static_cast<float>(SLICES) * std::log(near) / log_ratio;
+
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        bounds_min.at(axis).resize(CLUSTER_COUNT);
+        bounds_max.at(axis).resize(CLUSTER_COUNT);
+    }
+
+    glm::mat4 const inverse_projection = glm::inverse(projection);
+    auto unproject = [&inverse_projection](glm::vec2 ndc, float ndc_depth) {
+        glm::vec4 position = inverse_projection * glm::vec4(ndc, ndc_depth, 1.0F);
+        return glm::vec3(position) / position.w;
+    };
+
+    // Point at the given view depth on the line through the near and far point of a corner.
+    auto at_depth = [](glm::vec3 near_point, glm::vec3 far_point, float depth) {
+        float t = (depth + near_point.z) / (near_point.z - far_point.z);
+        return near_point + (far_point - near_point) * t;
+    };
+
+    for (std::uint32_t y = 0; y < TILES_Y; ++y) {
+        for (std::uint32_t x = 0; x < TILES_X; ++x) {
+            glm::vec2 const ndc_min{-1.0F + 2.0F * static_cast<float>(x) / TILES_X,
+                                    -1.0F + 2.0F * static_cast<float>(y) / TILES_Y};
+            glm::vec2 const ndc_max{-1.0F + 2.0F * static_cast<float>(x + 1) / TILES_X,
+                                    -1.0F + 2.0F * static_cast<float>(y + 1) / TILES_Y};
+
+            std::array<glm::vec2, 4> const corners{
+                ndc_min, glm::vec2(ndc_max.x, ndc_min.y), glm::vec2(ndc_min.x, ndc_max.y), ndc_max};
+
+            for (std::uint32_t z = 0; z < SLICES; ++z) {
+                float const depth_near =
+                    near * std::pow(far / near, static_cast<float>(z) / SLICES);
+                float const depth_far =
+                    near * std::pow(far / near, static_cast<float>(z + 1) / SLICES);
+
+                glm::vec3 cluster_min(std::numeric_limits<float>::max());
+                glm::vec3 cluster_max(std::numeric_limits<float>::lowest());
+
+                for (auto corner : corners) {
+                    glm::vec3 near_point = unproject(corner, -1.0F);
+                    glm::vec3 far_point = unproject(corner, 1.0F);
+
+                    for (float depth : {depth_near, depth_far}) {
+                        glm::vec3 point = at_depth(near_point, far_point, depth);
+                        cluster_min = glm::min(cluster_min, point);
+                        cluster_max = glm::max(cluster_max, point);
+                    }
+                }
+
+                std::size_t const cluster = x + (y * TILES_X) + (z * TILES_X * TILES_Y);
+                for (glm::length_t axis = 0; axis < 3; ++axis) {
+                    bounds_min.at(axis)[cluster] = cluster_min[axis];
+                    bounds_max.at(axis)[cluster] = cluster_max[axis];
+                }
+            }
+        }
+    }
+}
+
+void ClusterGrid::assign(std::span<Sphere const> lights)
+{
+    hits.clear();
+    cluster_ranges.assign(CLUSTER_COUNT, Range{});
+
+    auto const& [min_x, min_y, min_z] = bounds_min;
+    auto const& [max_x, max_y, max_z] = bounds_max;
+
+    for (std::uint32_t light = 0; light < lights.size(); ++light) {
+        auto const [center, radius] = lights[light];
+
+        float const depth_min = std::max(-center.z - radius, near);
+        float const depth_max = std::min(-center.z + radius, far);
+
+        if (depth_min > depth_max) {
+            continue;
+        }
+
+        // Conservative screen rectangle of the light from the projected corners of its
+        // bounding box, clipped to the depth range of the grid.
+        glm::vec2 ndc_min(std::numeric_limits<float>::max());
+        glm::vec2 ndc_max(std::numeric_limits<float>::lowest());
+
+        for (float depth : {depth_min, depth_max}) {
+            for (float dx : {-radius, radius}) {
+                for (float dy : {-radius, radius}) {
+                    glm::vec4 clip =
+                        projection * glm::vec4(center.x + dx, center.y + dy, -depth, 1.0F);
+                    glm::vec2 ndc = glm::vec2(clip) / clip.w;
+                    ndc_min = glm::min(ndc_min, ndc);
+                    ndc_max = glm::max(ndc_max, ndc);
+                }
+            }
+        }
+
+        if (ndc_min.x > 1.0F || ndc_min.y > 1.0F || ndc_max.x < -1.0F || ndc_max.y < -1.0F) {
+            continue;
+        }
+
+        std::uint32_t const x_begin = tile(ndc_min.x, TILES_X);
+        std::uint32_t const x_end = tile(ndc_max.x, TILES_X) + 1;
+        std::uint32_t const y_begin = tile(ndc_min.y, TILES_Y);
+        std::uint32_t const y_end = tile(ndc_max.y, TILES_Y) + 1;
+        std::uint32_t const z_begin = slice(depth_min);
+        std::uint32_t const z_end = slice(depth_max) + 1;
+
+        float const radius_squared = radius * radius;
+
+        for (std::uint32_t z = z_begin; z < z_end; ++z) {
+            for (std::uint32_t y = y_begin; y < y_end; ++y) {
+                std::size_t const row = (y * TILES_X) + (z * TILES_X * TILES_Y);
+
+                // Branchless sphere-box test of the whole row, which compilers vectorize.
+                // NOLINTBEGIN(cppcoreguidelines-pro-bounds-constant-array-index)
+                std::array<bool, TILES_X> inside{};
+                for (std::uint32_t x = x_begin; x < x_end; ++x) {
+                    std::size_t const cluster = row + x;
+                    float const dx = std::max(std::max(min_x[cluster] - center.x, 0.0F),
+                                              center.x - max_x[cluster]);
+                    float const dy = std::max(std::max(min_y[cluster] - center.y, 0.0F),
+                                              center.y - max_y[cluster]);
+                    float const dz = std::max(std::max(min_z[cluster] - center.z, 0.0F),
+                                              center.z - max_z[cluster]);
+                    inside[x] = dx * dx + dy * dy + dz * dz <= radius_squared;
+                }
+                // NOLINTEND(cppcoreguidelines-pro-bounds-constant-array-index)
+
+                for (std::uint32_t x = x_begin; x < x_end; ++x) {
+                    if (inside.at(x)) {
+                        auto const cluster = static_cast<std::uint32_t>(row + x);
+                        hits.push_back(Hit{.cluster = cluster, .light = light});
+                        ++cluster_ranges[cluster].count;
+                    }
+                }
+            }
+        }
+    }
+
+    std::uint32_t offset = 0;
+    for (auto& range : cluster_ranges) {
+        range.offset = offset;
+        offset += range.count;
+    }
+
+    // Scatter the hits into the index list, which keeps the lights of a cluster in order.
+    indices.resize(hits.size());
+    for (auto const& hit : hits) {
+        auto& range = cluster_ranges[hit.cluster];
+        indices[range.offset++] = hit.light;
+    }
+
+    for (auto& range : cluster_ranges) {
+        range.offset -= range.count;
+    }
+}
+
+auto ClusterGrid::slice(float depth) const -> std::uint32_t
+{
+    float const slice = std::floor(std::log(depth) * scale + bias);
+    return static_cast<std::uint32_t>(std::clamp(slice, 0.0F, static_cast<float>(SLICES - 1)));
+}
+
+auto ClusterGrid::tile(float ndc, std::uint32_t tiles) -> std::uint32_t
+{
+    float const tile = std::floor((ndc * 0.5F + 0.5F) * static_cast<float>(tiles));
+    return static_cast<std::uint32_t>(std::clamp(tile, 0.0F, static_cast<float>(tiles - 1)));
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+// Divides the view frustum into clusters, tiled in normalized screen space and sliced
+// exponentially in depth, and assigns spherical lights to all clusters they touch.
+class ClusterGrid
+{
+public:
+    static constexpr std::uint32_t TILES_X = 16;
+    static constexpr std::uint32_t TILES_Y = 9;
+    static constexpr std::uint32_t SLICES = 24;
+    static constexpr std::size_t CLUSTER_COUNT = std::size_t{TILES_X} * TILES_Y * SLICES;
+
+    // Light volume in view space.
+    struct Sphere
+    {
+        glm::vec3 center;
+        float radius;
+    };
+
+    // Lights of a cluster in the light index list.
+    struct Range
+    {
+        std::uint32_t offset;
+        std::uint32_t count;
+    };
+
+    // Recomputes the bounds of the clusters if the projection changed.
+    void set_projection(glm::mat4 const &projection, float near, float far);
+
+    void assign(std::span<Sphere const> lights);
+
+    // The depth slice of a view depth d is floor(log(d) * depth_scale + depth_bias).
+    [[nodiscard]] auto depth_scale() const -> float { return scale; }
+    [[nodiscard]] auto depth_bias() const -> float { return bias; }
+
+    [[nodiscard]] auto ranges() const -> std::span<Range const> { return cluster_ranges; }
+    [[nodiscard]] auto light_indices() const -> std::span<std::uint32_t const> { return indices; }
+
+private:
+    struct Hit
+    {
+        std::uint32_t cluster;
+        std::uint32_t light;
+    };
+
+    [[nodiscard]] auto slice(float depth) const -> std::uint32_t;
+    [[nodiscard]] static auto tile(float ndc, std::uint32_t tiles) -> std::uint32_t;
+
+    glm::mat4 projection{};
+    float near{};
+    float far{};
+    float scale{};
+    float bias{};
+
+    // Axis aligned view space bounds of the clusters, stored as separate arrays so that the
+    // clusters of a row can be tested against a light in one vectorizable loop.
+    std::array<std::vector<float>, 3> bounds_min;
+    std::array<std::vector<float>, 3> bounds_max;
+
+    std::vector<Hit> hits;
+    std::vector<Range> cluster_ranges;
+    std::vector<std::uint32_t> indices;
+};
@@ -0,0 +1,157 @@
+#include "command_buffer.h"
+
+void CommandBuffer::append_targets(std::vector<Target>& targets,
+                                   std::vector<Target> const& other,
+                                   std::uint32_t created_offset)
+{
+    targets.reserve(targets.size() + other.size());
+    for (auto target : other) {
+        if (auto* entity = std::get_if<Entity>(&target)) {
+            entity->index += created_offset;
+        }
+        targets.push_back(target);
+    }
+}
+
+auto CommandBuffer::resolve(Target target, std::span<entt::entity const> created) -> entt::entity
+{
+    if (auto const* entity = std::get_if<Entity>(&target)) {
+        return created[entity->index];
+    }
+    return std::get<entt::entity>(target);
+}
+
+auto CommandBuffer::resolve(std::span<Target const> targets,
+                            std::span<entt::entity const> created) -> std::vector<entt::entity>
+{
+    std::vector<entt::entity> entities;
+    entities.reserve(targets.size());
+    for (auto target : targets) {
+        entities.push_back(resolve(target, created));
+    }
+    return entities;
+}
+
+void CommandBuffer::push_run(Operation operation,
+                             std::size_t pool,
+                             std::size_t target_begin,
+                             std::size_t component_begin,
+                             std::size_t count)
+{
+    if (!runs.empty()) {
+        auto& last = runs.back();
+        bool const has_components =
+            operation == Operation::Emplace || operation == Operation::EmplaceOrReplace;
+
+        if (last.operation == operation && last.pool == pool &&
+            last.target_begin + last.count == target_begin &&
+            (!has_components || last.component_begin + last.count == component_begin)) {
+            last.count += count;
+            return;
+        }
+    }
+
+    runs.push_back(Run{.operation = operation,
+                       .pool = pool,
+                       .target_begin = target_begin,
+                       .component_begin = component_begin,
+                       .count = count});
+}
+
+void CommandBuffer::append(CommandBuffer&& other)
+{
+    std::size_t const destroyed_offset = destroyed.size();
+    append_targets(destroyed, other.destroyed, created_count);
+
+    // Where the pools of the other buffer went and how far their contents were offset
+    struct Offsets
+    {
+        std::size_t pool;
+        std::size_t targets;
+        std::size_t components;
+    };
+
+    std::vector<Offsets> offsets;
+    offsets.reserve(other.pools.size());
+
+    for (auto const& other_pool : other.pools) {
+        auto [iterator, inserted] = pool_indices.try_emplace(other_pool->type(), pools.size());
+        if (inserted) {
+            pools.push_back(other_pool->make_empty());
+        }
+
+        auto& pool = *pools[iterator->second];
+        offsets.push_back(Offsets{.pool = iterator->second,
+                                  .targets = pool.targets.size(),
+                                  .components = pool.component_count()});
+        pool.append(*other_pool, created_count);
+    }
+
+    for (auto const& run : other.runs) {
+        if (run.pool == DESTROYED) {
+            push_run(run.operation,
+                     DESTROYED,
+                     run.target_begin + destroyed_offset,
+                     run.component_begin,
+                     run.count);
+            continue;
+        }
+
+        auto const& offset = offsets[run.pool];
+        push_run(run.operation,
+                 offset.pool,
+                 run.target_begin + offset.targets,
+                 run.component_begin + offset.components,
+                 run.count);
+    }
+
+    created_count += other.created_count;
+    other = CommandBuffer();
+}
+
+auto CommandBuffer::apply(entt::registry& registry) -> std::vector<entt::entity>
+{
+    std::vector<entt::entity> created(created_count);
+    registry.create(created.begin(), created.end());
+
+    for (auto const& run : runs) {
+        if (run.pool == DESTROYED) {
+            auto entities = resolve(
+                std::span(destroyed).subspan(run.target_begin, run.count), created);
+            registry.destroy(entities.begin(), entities.end());
+        } else {
+            pools[run.pool]->apply(registry, run, created);
+        }
+    }
+
+    *this = CommandBuffer();
+    return created;
+}
+
+auto CommandQueue::reserve() -> Ticket
+{
+    std::lock_guard lock(mutex);
+    return next_ticket++;
+}
+
+void CommandQueue::submit(Ticket ticket, CommandBuffer buffer)
+{
+    std::lock_guard lock(mutex);
+    submitted.emplace(ticket, std::move(buffer));
+}
+
+void CommandQueue::apply(entt::registry& registry)
+{
+    CommandBuffer merged;
+    {
+        std::lock_guard lock(mutex);
+        while (!submitted.empty() && submitted.begin()->first == next_applied) {
+            merged.append(std::move(submitted.extract(submitted.begin()).mapped()));
+            ++next_applied;
+        }
+    }
+
+    if (!merged.empty()) {
+        merged.apply(registry);
+    }
+}
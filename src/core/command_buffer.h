@@ -0,0 +1,256 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <entt/entt.hpp>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Records structural changes of a registry to apply them later on one thread, so systems running
+// on worker threads and background loaders can create and destroy entities. Recording never
+// touches the registry.
+//
+// Commands apply in the order they were recorded, after all entities of the buffer are created.
+// Consecutive commands of the same kind and component type form a run, emplaced components of a
+// run are inserted into their pool in bulk.
+class CommandBuffer
+{
+public:
+    // Entity created by the buffer, it exists once the buffer was applied.
+    struct Entity
+    {
+        std::uint32_t index;
+    };
+
+    using Target = std::variant<entt::entity, Entity>;
+
+    CommandBuffer() = default;
+    ~CommandBuffer() = default;
+
+    CommandBuffer(CommandBuffer const&) = delete;
+    auto operator=(CommandBuffer const&) -> CommandBuffer& = delete;
+    CommandBuffer(CommandBuffer&&) = default;
+    auto operator=(CommandBuffer&&) -> CommandBuffer& = default;
+
+    auto create() -> Entity { return Entity{.index = created_count++}; }
+
+    void destroy(Target target)
+    {
+        push_run(Operation::Destroy, DESTROYED, destroyed.size(), 0);
+        destroyed.push_back(target);
+    }
+
+    // Like registry.emplace, the entity must not have the component when the command applies.
+    template <typename Component> void emplace(Target target, Component component)
+    {
+        record(Operation::Emplace, target, std::move(component));
+    }
+
+    template <typename Component> void emplace_or_replace(Target target, Component component)
+    {
+        record(Operation::EmplaceOrReplace, target, std::move(component));
+    }
+
+    template <typename Component> void remove(Target target)
+    {
+        auto [index, pool] = pool_of<Component>();
+        push_run(Operation::Remove, index, pool.targets.size(), pool.components.size());
+        pool.targets.push_back(target);
+    }
+
+    // Moves the commands of another buffer behind the ones of this buffer.
+    void append(CommandBuffer&& other);
+
+    // Returns the created entities in the order of create(), then clears the buffer.
+    auto apply(entt::registry& registry) -> std::vector<entt::entity>;
+
+    [[nodiscard]] auto empty() const -> bool { return created_count == 0 && runs.empty(); }
+
+private:
+    enum class Operation : std::uint8_t
+    {
+        Emplace,
+        EmplaceOrReplace,
+        Remove,
+        Destroy,
+    };
+
+    // Consecutive commands, their targets and components are consecutive in the pool as well.
+    struct Run
+    {
+        Operation operation;
+        std::size_t pool;
+        std::size_t target_begin;
+        std::size_t component_begin;
+        std::size_t count;
+    };
+
+    // Pool index of the runs destroying entities, whose targets are kept in destroyed
+    static constexpr std::size_t DESTROYED = static_cast<std::size_t>(-1);
+
+    class Pool
+    {
+    public:
+        Pool() = default;
+        virtual ~Pool() = default;
+
+        Pool(Pool const&) = delete;
+        auto operator=(Pool const&) -> Pool& = delete;
+        Pool(Pool&&) = delete;
+        auto operator=(Pool&&) -> Pool& = delete;
+
+        [[nodiscard]] virtual auto type() const -> entt::id_type = 0;
+        [[nodiscard]] virtual auto make_empty() const -> std::unique_ptr<Pool> = 0;
+        [[nodiscard]] virtual auto component_count() const -> std::size_t = 0;
+
+        // Entities created by the other buffer are offset by the ones created by this buffer.
+        virtual void append(Pool& other, std::uint32_t created_offset) = 0;
+        virtual void apply(entt::registry& registry,
+                           Run const& run,
+                           std::span<entt::entity const> created) = 0;
+
+        std::vector<Target> targets;
+    };
+
+    template <typename Component> class ComponentPool : public Pool
+    {
+    public:
+        [[nodiscard]] auto type() const -> entt::id_type override
+        {
+            return entt::type_hash<Component>::value();
+        }
+
+        [[nodiscard]] auto make_empty() const -> std::unique_ptr<Pool> override
+        {
+            return std::make_unique<ComponentPool>();
+        }
+
+        [[nodiscard]] auto component_count() const -> std::size_t override
+        {
+            return components.size();
+        }
+
+        void append(Pool& other, std::uint32_t created_offset) override
+        {
+            auto& pool = static_cast<ComponentPool&>(other);
+            append_targets(targets, pool.targets, created_offset);
+            std::ranges::move(pool.components, std::back_inserter(components));
+        }
+
+        void apply(entt::registry& registry,
+                   Run const& run,
+                   std::span<entt::entity const> created) override
+        {
+            auto entities =
+                resolve(std::span(targets).subspan(run.target_begin, run.count), created);
+            auto first_component =
+                components.begin() + static_cast<std::ptrdiff_t>(run.component_begin);
+
+            switch (run.operation) {
+            case Operation::Emplace:
+                if constexpr (std::is_empty_v<Component>) {
+                    registry.insert<Component>(entities.begin(), entities.end());
+                } else {
+                    registry.insert<Component>(
+                        entities.begin(), entities.end(), std::make_move_iterator(first_component));
+                }
+                break;
+
+            case Operation::EmplaceOrReplace:
+                for (std::size_t i = 0; i < entities.size(); ++i) {
+                    if constexpr (std::is_empty_v<Component>) {
+                        registry.emplace_or_replace<Component>(entities[i]);
+                    } else {
+                        auto& component = first_component[static_cast<std::ptrdiff_t>(i)];
+                        registry.emplace_or_replace<Component>(entities[i], std::move(component));
+                    }
+                }
+                break;
+
+            case Operation::Remove:
+                registry.remove<Component>(entities.begin(), entities.end());
+                break;
+
+            case Operation::Destroy:
+                break;
+            }
+        }
+
+        std::vector<Component> components;
+    };
+
+    template <typename Component>
+    void record(Operation operation, Target target, Component component)
+    {
+        auto [index, pool] = pool_of<Component>();
+        push_run(operation, index, pool.targets.size(), pool.components.size());
+        pool.targets.push_back(target);
+        pool.components.push_back(std::move(component));
+    }
+
+    // Extends the last run if the command continues it.
+    void push_run(Operation operation,
+                  std::size_t pool,
+                  std::size_t target_begin,
+                  std::size_t component_begin,
+                  std::size_t count = 1);
+
+    static void append_targets(std::vector<Target>& targets,
+                               std::vector<Target> const& other,
+                               std::uint32_t created_offset);
+    static auto resolve(Target target, std::span<entt::entity const> created) -> entt::entity;
+    static auto resolve(std::span<Target const> targets, std::span<entt::entity const> created)
+        -> std::vector<entt::entity>;
+
+    // Index and pool of a component type
+    template <typename Component>
+    auto pool_of() -> std::pair<std::size_t, ComponentPool<Component>&>
+    {
+        auto id = entt::type_hash<Component>::value();
+        auto [iterator, inserted] = pool_indices.try_emplace(id, pools.size());
+        if (inserted) {
+            pools.push_back(std::make_unique<ComponentPool<Component>>());
+        }
+        auto& pool = static_cast<ComponentPool<Component>&>(*pools[iterator->second]);
+        return {iterator->second, pool};
+    }
+
+    std::uint32_t created_count{};
+    std::vector<Target> destroyed;
+    std::vector<Run> runs;
+
+    // In the order the component types were first used
+    std::vector<std::unique_ptr<Pool>> pools;
+    std::map<entt::id_type, std::size_t> pool_indices;
+};
+
+// Collects the command buffers of background loaders, which finish in any order. Buffers are
+// applied in the order their tickets were taken, a buffer waits for all earlier ones.
+class CommandQueue
+{
+public:
+    using Ticket = std::uint64_t;
+
+    // Take the ticket when the work is started, on the thread that orders the work, e.g. the main
+    // thread. Every ticket has to be submitted, if only with an empty buffer.
+    auto reserve() -> Ticket;
+
+    // Thread-safe
+    void submit(Ticket ticket, CommandBuffer buffer);
+
+    // Applies the buffers submitted in ticket order up to the first missing one.
+    void apply(entt::registry& registry);
+
+private:
+    std::mutex mutex;
+    Ticket next_ticket{};
+    Ticket next_applied{};
+    std::map<Ticket, CommandBuffer> submitted;
+};
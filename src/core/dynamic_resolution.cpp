@@ -0,0 +1,98 @@
+#include "dynamic_resolution.h"
+#include "core/graphics/gpu_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DynamicResolution {
+
+namespace {
+
+// Scales are quantized, so that the texture pool only ever sees a few distinct target sizes.
+constexpr float SCALE_STEP = 1.0F / 16.0F;
+
+// Frames measured at the current scale before it is adjusted again. Averaging over several
+// frames keeps single spikes from changing the resolution.
+constexpr std::uint64_t ADJUST_FRAMES = 8;
+
+// The scale only grows when the frame time is this far below the target, which keeps it from
+// oscillating between two steps.
+constexpr float HEADROOM = 0.8F;
+
+struct FeedbackContext
+{
+    // Profiler frames before this one were recorded
+    std::uint64_t next_frame{};
+    std::uint64_t frames_since_adjustment{};
+};
+
+auto average(State const& state, std::uint64_t frames) -> float
+{
+    float sum = 0.0F;
+    for (std::uint64_t i = 1; i <= frames; ++i) {
+        sum += state.frame_times.at((state.measured_frames - i) % HISTORY_SIZE);
+    }
+
+    return sum / static_cast<float>(frames);
+}
+
+void adjust(Settings const& settings, State& state, FeedbackContext& context)
+{
+    if (!settings.enabled) {
+        state.scale = settings.max_scale;
+        state.settled = true;
+        return;
+    }
+
+    if (context.frames_since_adjustment < ADJUST_FRAMES) {
+        state.settled = false;
+        return;
+    }
+
+    float const frame_time = average(state, ADJUST_FRAMES);
+
+    // The cost of a frame is roughly proportional to its pixel count, the square of the scale.
+    float const ideal_scale = state.scale * std::sqrt(settings.target_frame_time / frame_time);
+
+    float scale = state.scale;
+    if (ideal_scale < state.scale) {
+        scale = std::floor(ideal_scale / SCALE_STEP) * SCALE_STEP;
+    } else if (frame_time < settings.target_frame_time * HEADROOM) {
+        scale = state.scale + SCALE_STEP;
+    }
+
+    scale = std::clamp(scale, settings.min_scale, settings.max_scale);
+    state.settled = scale == state.scale;
+    if (scale != state.scale) {
+        state.scale = scale;
+        context.frames_since_adjustment = 0;
+    }
+}
+
+} // namespace
+
+void update(entt::registry& registry)
+{
+    auto& context = registry.ctx().emplace<FeedbackContext>();
+    auto& state = registry.ctx().get<State>();
+    auto const& latest = registry.ctx().get<GpuProfiler>().latest();
+
+    if (!latest.timings.empty() && latest.frame >= context.next_frame) {
+        context.next_frame = latest.frame + 1;
+        ++context.frames_since_adjustment;
+
+        state.frame_times.at(state.measured_frames % HISTORY_SIZE) = latest.milliseconds;
+        ++state.measured_frames;
+    }
+
+    adjust(registry.ctx().get<Settings>(), state, context);
+}
+
+auto scaled(entt::registry const& registry, glm::u32vec2 dimensions) -> glm::u32vec2
+{
+    float const scale = registry.ctx().get<State>().scale;
+
+    return glm::max(glm::u32vec2(glm::round(glm::vec2(dimensions) * scale)), glm::u32vec2(1));
+}
+
+} // namespace DynamicResolution
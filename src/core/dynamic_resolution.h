@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+
+// Renders the scene at a fraction of the target resolution when the GPU cannot keep up with
+// the frame time budget. Post-processing upscales the result to the window.
+namespace DynamicResolution {
+
+static constexpr std::size_t HISTORY_SIZE = 64;
+
+struct Settings
+{
+    bool enabled = true;
+
+    // GPU time per frame in milliseconds the scale is adjusted for.
+    float target_frame_time = 16.6F;
+
+    // Bounds of the scale applied to both dimensions of the target resolution.
+    float min_scale = 0.5F;
+    float max_scale = 1.0F;
+};
+
+// Telemetry of the feedback loop.
+struct State
+{
+    float scale = 1.0F;
+
+    // Whether the frames measured at the scale neither call for a smaller nor allow a larger
+    // one, so that frames keep being rendered at it.
+    bool settled = false;
+
+    // GPU frame times in milliseconds, the latest at (measured_frames - 1) % HISTORY_SIZE.
+    std::array<float, HISTORY_SIZE> frame_times{};
+    std::uint64_t measured_frames{};
+};
+
+// Records the GPU time of the latest frame measured by the GpuProfiler and adjusts the scale.
+void update(entt::registry& registry);
+
+// Dimensions to render the scene at for the given target dimensions.
+auto scaled(entt::registry const& registry, glm::u32vec2 dimensions) -> glm::u32vec2;
+
+} // namespace DynamicResolution
@@ -0,0 +1,32 @@
+#include "frame_limiter.h"
+
+#include <thread>
+
+FrameLimiter::FrameLimiter(double frames_per_second) :
+    period(std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / frames_per_second))),
+    deadline(Clock::now() + period)
+{
+}
+
+void FrameLimiter::wait()
+{
+    auto const now = Clock::now();
+
+    // A frame running late by more than a period starts a new schedule, the following frames
+    // are not rushed to make up for it.
+    if (now - deadline > period) {
+        deadline = now + period;
+        return;
+    }
+
+    if (deadline - now > SPIN_TIME) {
+        std::this_thread::sleep_until(deadline - SPIN_TIME);
+    }
+
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+
+    deadline += period;
+}
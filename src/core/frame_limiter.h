@@ -0,0 +1,22 @@
+#pragma once
+
+#include <chrono>
+
+// Paces frames to a target rate. Sleeping overshoots by up to a scheduler tick, so the last
+// stretch before the end of a frame is spent spinning instead.
+class FrameLimiter
+{
+public:
+    explicit FrameLimiter(double frames_per_second);
+
+    // Returns once the current frame took up its share of time.
+    void wait();
+
+private:
+    static constexpr std::chrono::microseconds SPIN_TIME{1500};
+
+    using Clock = std::chrono::steady_clock;
+
+    Clock::duration period;
+    Clock::time_point deadline;
+};
@@ -0,0 +1,23 @@
+#include "buffer.h"
+
+#include <algorithm>
+
+Buffer::Buffer(GLenum target) : target(target)
+{
+    glGenBuffers(1, &buffer);
+}
+
+void Buffer::upload(void const* data, GLsizeiptr size)
+{
+    bind();
+
+    if (size > capacity) {
+        capacity = std::max(size, capacity * 2);
+    }
+
+    glBufferData(target, capacity, nullptr, GL_STREAM_DRAW);
+
+    if (size > 0) {
+        glBufferSubData(target, 0, size, data);
+    }
+}
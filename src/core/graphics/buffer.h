@@ -0,0 +1,53 @@
+#pragma once
+
+#include "gl_state.h"
+
+#include <glad/gl.h>
+#include <vector>
+
+// Owning wrapper around an OpenGL buffer object.
+struct Buffer
+{
+    Buffer(GLenum target);
+
+    Buffer(Buffer const &) = delete;
+    auto operator=(Buffer const &) -> Buffer & = delete;
+
+    Buffer(Buffer &&other) noexcept
+        : target(other.target), buffer(other.buffer), capacity(other.capacity)
+    {
+        other.buffer = 0;
+        other.capacity = 0;
+    }
+
+    auto operator=(Buffer &&other) noexcept -> Buffer &
+    {
+        GlState::delete_buffer(buffer);
+
+        target = other.target;
+        buffer = other.buffer;
+        capacity = other.capacity;
+
+        other.buffer = 0;
+        other.capacity = 0;
+        return *this;
+    };
+
+    ~Buffer() { GlState::delete_buffer(buffer); };
+
+    void bind() const { GlState::bind_buffer(target, buffer); }
+    void bind_base(GLuint index) const { GlState::bind_buffer_base(target, index, buffer); }
+
+    // Replaces the content of the buffer. The storage grows geometrically and is orphaned
+    // otherwise, so that uploading does not wait for draws still reading the old content.
+    void upload(void const *data, GLsizeiptr size);
+
+    template <typename T> void upload(std::vector<T> const &data)
+    {
+        upload(data.data(), static_cast<GLsizeiptr>(data.size() * sizeof(T)));
+    }
+
+    GLenum target;
+    GLuint buffer{};
+    GLsizeiptr capacity{};
+};
@@ -0,0 +1,276 @@
+#include "frame_capture.h"
+#include "gl_state.h"
+#include "util/png.h"
+#include "util/profiler.h"
+
+#include <cstring>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace {
+
+constexpr std::size_t CHANNELS = 4;
+
+// Nanoseconds to block in glClientWaitSync before trying again.
+constexpr GLuint64 FENCE_TIMEOUT = 1'000'000;
+
+auto frame_name(std::uint64_t frame, std::string_view suffix = {}) -> std::string
+{
+    return fmt::format("frame_{:05}{}.png", frame, suffix);
+}
+
+} // namespace
+
+FrameCapture::FrameCapture(Options options) :
+    options(std::move(options)), writer(&FrameCapture::write_frames, this)
+{
+    for (auto& slot : slots) {
+        glGenBuffers(1, &slot.buffer);
+    }
+}
+
+FrameCapture::~FrameCapture()
+{
+    finish();
+
+    for (auto& slot : slots) {
+        GlState::delete_buffer(slot.buffer);
+    }
+}
+
+void FrameCapture::capture(std::uint64_t frame, glm::u32vec2 dimensions)
+{
+    FEVER_PROFILE_ZONE("capture");
+
+    if (dimensions.x == 0 || dimensions.y == 0) {
+        return;
+    }
+
+    auto& slot = slots.at(next_slot);
+    next_slot = (next_slot + 1) % RING_SIZE;
+
+    if (slot.fence != nullptr) {
+        ++summary.stalls;
+        resolve(slot, true);
+    }
+
+    auto const size = static_cast<GLsizeiptr>(dimensions.x * dimensions.y * CHANNELS);
+
+    GlState::bind_buffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (slot.capacity < size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        slot.capacity = size;
+    }
+
+    // With a pack buffer bound, the read is queued like a draw and returns immediately.
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0,
+                 0,
+                 static_cast<GLsizei>(dimensions.x),
+                 static_cast<GLsizei>(dimensions.y),
+                 GL_RGBA,
+                 GL_UNSIGNED_BYTE,
+                 nullptr);
+    GlState::bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.frame = frame;
+    slot.dimensions = dimensions;
+}
+
+void FrameCapture::poll()
+{
+    // Fences signal in order, so frames are queued in order as well.
+    for (std::size_t i = 0; i < RING_SIZE; ++i) {
+        auto& slot = slots.at((next_slot + i) % RING_SIZE);
+
+        if (slot.fence != nullptr && !resolve(slot, false)) {
+            return;
+        }
+    }
+}
+
+auto FrameCapture::finish() -> Summary
+{
+    if (!writer.joinable()) {
+        return summary;
+    }
+
+    for (std::size_t i = 0; i < RING_SIZE; ++i) {
+        auto& slot = slots.at((next_slot + i) % RING_SIZE);
+
+        if (slot.fence != nullptr) {
+            resolve(slot, true);
+        }
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    queue_changed.notify_one();
+    writer.join();
+
+    if (summary.dropped != 0) {
+        spdlog::warn("Dropped {} captured frames, writing could not keep up", summary.dropped);
+    }
+
+    return summary;
+}
+
+auto FrameCapture::resolve(Slot& slot, bool wait) -> bool
+{
+    GLenum status = glClientWaitSync(slot.fence, 0, 0);
+    while (wait && status == GL_TIMEOUT_EXPIRED) {
+        status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+    }
+
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    std::vector<std::uint8_t> pixels;
+    {
+        std::unique_lock lock(mutex);
+
+        // A frame missing its comparison would let a reference run pass unchecked.
+        if (options.reference_directory.has_value()) {
+            queue_drained.wait(lock, [this] { return jobs.size() < MAX_QUEUED_FRAMES; });
+        } else if (jobs.size() >= MAX_QUEUED_FRAMES) {
+            ++summary.dropped;
+            return true;
+        }
+
+        if (!free_buffers.empty()) {
+            pixels = std::move(free_buffers.back());
+            free_buffers.pop_back();
+        }
+    }
+
+    pixels.resize(static_cast<std::size_t>(slot.dimensions.x) * slot.dimensions.y * CHANNELS);
+
+    GlState::bind_buffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    void const* mapping = glMapBufferRange(
+        GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(pixels.size()), GL_MAP_READ_BIT);
+    if (mapping != nullptr) {
+        std::memcpy(pixels.data(), mapping, pixels.size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    GlState::bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (mapping == nullptr) {
+        spdlog::error("Could not map the readback of frame {}", slot.frame);
+
+        std::lock_guard lock(mutex);
+        ++summary.failed;
+        free_buffers.push_back(std::move(pixels));
+        return true;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        jobs.push_back(
+            Job{.frame = slot.frame, .dimensions = slot.dimensions, .pixels = std::move(pixels)});
+    }
+    queue_changed.notify_one();
+
+    return true;
+}
+
+void FrameCapture::write_frames()
+{
+    FEVER_PROFILE_THREAD("capture");
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock lock(mutex);
+            queue_changed.wait(lock, [this] { return stopping || !jobs.empty(); });
+
+            if (jobs.empty()) {
+                return;
+            }
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        queue_drained.notify_one();
+
+        write(job);
+
+        if (options.reference_directory.has_value()) {
+            compare(job);
+        }
+
+        std::lock_guard lock(mutex);
+        free_buffers.push_back(std::move(job.pixels));
+    }
+}
+
+void FrameCapture::write(Job const& job)
+{
+    FEVER_PROFILE_ZONE("write_frame");
+
+    bool written = false;
+
+    switch (options.format) {
+    case Format::Png:
+        written = Png::write(
+            options.output_directory / frame_name(job.frame), job.dimensions, job.pixels);
+        break;
+
+    case Format::Y4m:
+        // The first frame decides the dimensions of the video.
+        if (!video.has_value()) {
+            video.emplace(
+                options.output_directory / "capture.y4m", job.dimensions, options.frame_rate);
+        }
+        written = video->write(job.dimensions, job.pixels);
+        break;
+    }
+
+    if (written) {
+        ++summary.written;
+    } else {
+        // Also counted by resolve for failed readbacks
+        std::lock_guard lock(mutex);
+        ++summary.failed;
+    }
+}
+
+void FrameCapture::compare(Job const& job)
+{
+    FEVER_PROFILE_ZONE("compare_frame");
+
+    auto reference_path = options.reference_directory.value() / frame_name(job.frame);
+    auto reference = ImageDiff::load(reference_path);
+    if (!reference.has_value()) {
+        ++summary.mismatched;
+        return;
+    }
+
+    auto candidate = ImageDiff::from_bottom_to_top(job.dimensions, job.pixels);
+    auto result = ImageDiff::compare(reference.value(), candidate, options.tolerance);
+
+    if (!result.has_value()) {
+        spdlog::warn("Frame {} does not have the dimensions of its reference", job.frame);
+        ++summary.mismatched;
+        return;
+    }
+
+    if (!result->passed) {
+        spdlog::warn("Frame {} differs from its reference in {} pixels, max delta E {:.1f}",
+                     job.frame,
+                     result->differing_pixels,
+                     result->max_delta_e);
+        ++summary.mismatched;
+
+        Png::write(options.output_directory / frame_name(job.frame, "_diff"),
+                   result->visualization.dimensions,
+                   result->visualization.rgba,
+                   Png::RowOrder::TopToBottom);
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "util/image_diff.h"
+#include "util/y4m.h"
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Captures frames without stalling the GPU. The bound framebuffer is read into a ring of pixel
+// buffer objects, which are mapped once their fence signals a few frames later. Encoding happens
+// on a writer thread, which optionally compares every frame against a reference image.
+class FrameCapture
+{
+public:
+    static constexpr std::size_t RING_SIZE = 3;
+
+    // Frames waiting for the writer thread. Further frames are dropped rather than blocking
+    // the render loop, unless they are compared against references.
+    static constexpr std::size_t MAX_QUEUED_FRAMES = 8;
+
+    enum class Format
+    {
+        Png, // One file per frame, named frame_00042.png
+        Y4m, // A single uncompressed video, capture.y4m
+    };
+
+    struct Options
+    {
+        Format format = Format::Png;
+        std::filesystem::path output_directory;
+        unsigned frame_rate = 60;
+
+        // Compares every frame against the image of the same name in this directory.
+        std::optional<std::filesystem::path> reference_directory;
+        ImageDiff::Tolerance tolerance{};
+    };
+
+    struct Summary
+    {
+        std::size_t written{};
+        std::size_t dropped{};
+
+        // Frames that had to wait for their readback, as the ring was full
+        std::size_t stalls{};
+
+        // Frames differing from their reference or without one
+        std::size_t mismatched{};
+
+        // Frames that could not be read back or written
+        std::size_t failed{};
+    };
+
+    explicit FrameCapture(Options options);
+    ~FrameCapture();
+
+    FrameCapture(FrameCapture const&) = delete;
+    auto operator=(FrameCapture const&) -> FrameCapture& = delete;
+    FrameCapture(FrameCapture&&) = delete;
+    auto operator=(FrameCapture&&) -> FrameCapture& = delete;
+
+    // Starts the readback of the bound read framebuffer, which should be an offscreen target.
+    // Reading the default framebuffer of a hidden window returns undefined pixels.
+    void capture(std::uint64_t frame, glm::u32vec2 dimensions);
+
+    // Hands the readbacks the GPU finished to the writer thread. Call once per frame.
+    void poll();
+
+    // Waits for all readbacks and writes. Has to be called while the context is current.
+    auto finish() -> Summary;
+
+private:
+    struct Slot
+    {
+        GLuint buffer{};
+        GLsizeiptr capacity{};
+        GLsync fence{};
+
+        std::uint64_t frame{};
+        glm::u32vec2 dimensions{};
+    };
+
+    struct Job
+    {
+        std::uint64_t frame;
+        glm::u32vec2 dimensions;
+        std::vector<std::uint8_t> pixels;
+    };
+
+    // Queues the pixels of the slot once its readback finished. Returns false if it has not
+    // and wait is false.
+    auto resolve(Slot& slot, bool wait) -> bool;
+
+    void write_frames();
+    void write(Job const& job);
+    void compare(Job const& job);
+
+    Options options;
+
+    std::array<Slot, RING_SIZE> slots;
+    std::size_t next_slot{};
+
+    std::mutex mutex;
+    std::condition_variable queue_changed;
+    std::condition_variable queue_drained;
+    std::deque<Job> jobs;
+    std::vector<std::vector<std::uint8_t>> free_buffers;
+    bool stopping{};
+
+    // Only touched by the writer thread until it is joined
+    std::optional<Y4mWriter> video;
+
+    Summary summary;
+    std::thread writer;
+};
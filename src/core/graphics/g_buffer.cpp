@@ -0,0 +1,61 @@
+#include "g_buffer.h"
+
+namespace {
+
+constexpr std::array<GLenum, GBuffer::COLOR_ATTACHMENTS + 1> FORMATS{
+    GL_RGBA8, GL_RGBA16F, GL_RGBA8, GL_DEPTH24_STENCIL8};
+
+} // namespace
+
+GBuffer::GBuffer()
+{
+    glGenVertexArrays(1, &empty_vertex_array);
+}
+
+GBuffer::~GBuffer()
+{
+    GlState::delete_vertex_array(empty_vertex_array);
+}
+
+void GBuffer::bind(TexturePool& pool, glm::u32vec2 physical_dimensions)
+{
+    dimensions = physical_dimensions;
+
+    for (std::size_t i = 0; i < attachments.size(); ++i) {
+        attachments.at(i) = pool.acquire(
+            TextureDescription{.dimensions = dimensions, .internal_format = FORMATS.at(i)});
+    }
+
+    pool.bind_framebuffer(attachments);
+}
+
+void GBuffer::resolve(TexturePool& pool, Shader const& lighting_shader, GLuint target_frame_buffer)
+{
+    GlState::bind_framebuffer(target_frame_buffer);
+
+    lighting_shader.bind();
+
+    for (std::size_t i = 0; i < attachments.size(); ++i) {
+        GlState::bind_texture(static_cast<GLuint>(i), attachments.at(i));
+    }
+
+    GlState::bind_vertex_array(empty_vertex_array);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // Later passes depth test against the scene geometry. Binding the G-buffer again finds its
+    // framebuffer in the pool; only the draw binding is changed afterwards, so the cached
+    // binding is restored.
+    auto width = static_cast<GLint>(dimensions.x);
+    auto height = static_cast<GLint>(dimensions.y);
+
+    pool.bind_framebuffer(attachments);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target_frame_buffer);
+    glBlitFramebuffer(
+        0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    GlState::bind_framebuffer(target_frame_buffer);
+
+    for (GLuint& texture : attachments) {
+        pool.release(texture);
+        texture = 0;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "core/shader.h"
+#include "gl_state.h"
+#include "texture_pool.h"
+
+#include <array>
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+// Render targets of the deferred path: albedo, world space normal, material parameters and
+// depth. The lighting pass reads them from the texture units of the same index. The targets are
+// taken from a TexturePool for the duration of a frame, so a changing render resolution reuses
+// the textures of recent sizes instead of reallocating them.
+struct GBuffer
+{
+    static constexpr std::size_t COLOR_ATTACHMENTS = 3;
+    static constexpr GLuint DEPTH_TEXTURE_UNIT = COLOR_ATTACHMENTS;
+
+    GBuffer();
+    ~GBuffer();
+
+    GBuffer(GBuffer const&) = delete;
+    auto operator=(GBuffer const&) -> GBuffer& = delete;
+    GBuffer(GBuffer&&) = delete;
+    auto operator=(GBuffer&&) -> GBuffer& = delete;
+
+    // Acquires the targets of the given size and binds them for drawing the geometry.
+    void bind(TexturePool& pool, glm::u32vec2 physical_dimensions);
+
+    // Lights every covered pixel into the target framebuffer, then copies the depth buffer
+    // there as well and returns the targets to the pool.
+    void resolve(TexturePool& pool, Shader const& lighting_shader, GLuint target_frame_buffer);
+
+    glm::u32vec2 dimensions{};
+
+    // Color targets followed by the depth target, zero while not acquired.
+    std::array<GLuint, COLOR_ATTACHMENTS + 1> attachments{};
+
+    // A VAO is necessary although no data is stored in it
+    GLuint empty_vertex_array{};
+};
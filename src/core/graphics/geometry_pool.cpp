@@ -0,0 +1,247 @@
+#include "geometry_pool.h"
+#include "gl_queue.h"
+#include "gl_state.h"
+
+#include <algorithm>
+#include <bit>
+#include <entt/entt.hpp>
+#include <limits>
+#include <numeric>
+
+// Moves the content of a buffer into a new, larger allocation.
+static void grow_buffer(GLuint& buffer, GLsizeiptr used_size, GLsizeiptr new_size)
+{
+    GLuint new_buffer{};
+    glGenBuffers(1, &new_buffer);
+    GlState::bind_buffer(GL_COPY_WRITE_BUFFER, new_buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, new_size, nullptr, GL_STATIC_DRAW);
+
+    if (buffer != 0) {
+        GlState::bind_buffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used_size);
+        GlState::delete_buffer(buffer);
+    }
+
+    buffer = new_buffer;
+}
+
+static auto mesh_vertex_count(Mesh const& mesh) -> std::size_t
+{
+    return mesh.attributes.empty() ? 0
+                                   : std::visit([](auto&& arg) { return arg.size(); },
+                                                mesh.attributes.begin()->second.values);
+}
+
+static auto mesh_index_count(Mesh const& mesh) -> std::size_t
+{
+    return std::visit([](auto&& arg) { return arg.size(); }, mesh.indices.values);
+}
+
+// Sphere around the bounding box of the positions at attribute location 0.
+static auto bounding_sphere(Mesh const& mesh) -> glm::vec4
+{
+    auto positions = mesh.attributes.find(0);
+    if (positions == mesh.attributes.end()) {
+        return {};
+    }
+
+    auto const* values = std::get_if<VertexAttributeData::Vec3>(&positions->second.values);
+    if (values == nullptr || values->empty()) {
+        return {};
+    }
+
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(std::numeric_limits<float>::lowest());
+    for (auto const& value : *values) {
+        glm::vec3 position(value[0], value[1], value[2]);
+        min = glm::min(min, position);
+        max = glm::max(max, position);
+    }
+
+    return {(min + max) * 0.5F, glm::length(max - min) * 0.5F};
+}
+
+GeometryBuffer::GeometryBuffer(VertexLayout const& layout) : layout(layout)
+{
+    glGenVertexArrays(1, &vertex_array);
+}
+
+GeometryBuffer::~GeometryBuffer()
+{
+    GlState::delete_vertex_array(vertex_array);
+
+    for (GLuint vertex_buffer : vertex_buffers) {
+        GlState::delete_buffer(vertex_buffer);
+    }
+
+    GlState::delete_buffer(index_buffer);
+}
+
+void GeometryBuffer::append(Mesh const& mesh)
+{
+    std::size_t const mesh_vertices = mesh_vertex_count(mesh);
+
+    auto const mesh_indices = std::visit(
+        [](auto&& arg) { return std::vector<uint32_t>(arg.cbegin(), arg.cend()); },
+        mesh.indices.values);
+
+    reserve(vertex_count + mesh_vertices, index_count + mesh_indices.size());
+
+    for (auto const& [attribute_id, attribute_data] : mesh.attributes) {
+        GlState::bind_buffer(GL_COPY_WRITE_BUFFER, vertex_buffers.at(attribute_id));
+
+        std::visit(
+            [this](auto&& arg) {
+                using T = typename std::decay_t<decltype(arg)>::value_type;
+                glBufferSubData(GL_COPY_WRITE_BUFFER,
+                                static_cast<GLintptr>(vertex_count * sizeof(T)),
+                                static_cast<GLsizeiptr>(arg.size() * sizeof(T)),
+                                arg.data());
+            },
+            attribute_data.values);
+    }
+
+    GlState::bind_buffer(GL_COPY_WRITE_BUFFER, index_buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER,
+                    static_cast<GLintptr>(index_count * sizeof(uint32_t)),
+                    static_cast<GLsizeiptr>(mesh_indices.size() * sizeof(uint32_t)),
+                    mesh_indices.data());
+
+    vertex_count += mesh_vertices;
+    index_count += mesh_indices.size();
+}
+
+void GeometryBuffer::reserve(std::size_t vertices, std::size_t indices)
+{
+    if (vertices > vertex_capacity) {
+        std::size_t const new_capacity = std::max(vertices, vertex_capacity * 2);
+
+        for (std::size_t location = 0; location < VertexLayout::MAX_ATTRIBUTES; ++location) {
+            auto const vertex_size =
+                static_cast<GLsizeiptr>(layout.components.at(location) * sizeof(float));
+
+            if (vertex_size == 0) {
+                continue;
+            }
+
+            grow_buffer(vertex_buffers.at(location),
+                        static_cast<GLsizeiptr>(vertex_count) * vertex_size,
+                        static_cast<GLsizeiptr>(new_capacity) * vertex_size);
+        }
+
+        vertex_capacity = new_capacity;
+        bind_attributes();
+    }
+
+    if (indices > index_capacity) {
+        std::size_t const new_capacity = std::max(indices, index_capacity * 2);
+
+        grow_buffer(index_buffer,
+                    static_cast<GLsizeiptr>(index_count * sizeof(uint32_t)),
+                    static_cast<GLsizeiptr>(new_capacity * sizeof(uint32_t)));
+
+        index_capacity = new_capacity;
+
+        GlState::bind_vertex_array(vertex_array);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+    }
+}
+
+void GeometryBuffer::bind_attributes() const
+{
+    GlState::bind_vertex_array(vertex_array);
+
+    for (std::size_t location = 0; location < VertexLayout::MAX_ATTRIBUTES; ++location) {
+        GLint const components = layout.components.at(location);
+
+        if (components == 0) {
+            continue;
+        }
+
+        auto const attribute_location = static_cast<GLuint>(location);
+
+        GlState::bind_buffer(GL_ARRAY_BUFFER, vertex_buffers.at(location));
+        glEnableVertexAttribArray(attribute_location);
+        glVertexAttribPointer(attribute_location, components, GL_FLOAT, GL_FALSE, 0, nullptr);
+    }
+}
+
+void GeometryBuffer::attach_draw_id_buffer(GLuint draw_id_buffer) const
+{
+    GlState::bind_vertex_array(vertex_array);
+
+    GlState::bind_buffer(GL_ARRAY_BUFFER, draw_id_buffer);
+    glEnableVertexAttribArray(GeometryPool::DRAW_ID_LOCATION);
+    glVertexAttribIPointer(GeometryPool::DRAW_ID_LOCATION, 1, GL_UNSIGNED_INT, 0, nullptr);
+    glVertexAttribDivisor(GeometryPool::DRAW_ID_LOCATION, 1);
+}
+
+GeometryPool::GeometryPool()
+{
+    reserve_draw_ids(INITIAL_DRAW_IDS);
+}
+
+void GeometryPool::append(std::uint32_t layout_index, Mesh const& mesh)
+{
+    if (layout_index == geometry_buffers.size()) {
+        auto& geometry_buffer =
+            geometry_buffers.emplace_back(std::make_unique<GeometryBuffer>(VertexLayout::of(mesh)));
+        geometry_buffer->attach_draw_id_buffer(draw_id_buffer.buffer);
+    }
+
+    geometry_buffers.at(layout_index)->append(mesh);
+}
+
+auto GeometryPool::vertex_array(std::uint32_t layout_index) const -> GLuint
+{
+    return geometry_buffers.at(layout_index)->vao();
+}
+
+void GeometryPool::reserve_draw_ids(std::size_t count)
+{
+    if (count <= draw_id_capacity) {
+        return;
+    }
+
+    draw_id_capacity = std::bit_ceil(count);
+
+    std::vector<GLuint> draw_ids(draw_id_capacity);
+    std::iota(draw_ids.begin(), draw_ids.end(), 0);
+
+    draw_id_buffer.upload(draw_ids);
+}
+
+auto GeometryUploader::upload(Mesh const& mesh) -> GpuMesh
+{
+    auto const next_index = static_cast<std::uint32_t>(layouts.size());
+    auto& layout = layouts.try_emplace(VertexLayout::of(mesh), Layout{.index = next_index})
+                       .first->second;
+
+    auto const mesh_vertices = mesh_vertex_count(mesh);
+    auto const mesh_indices = mesh_index_count(mesh);
+
+    // The pool appends in the same order, so the mesh ends up behind the meshes counted here.
+    GpuMesh gpu_mesh{.id = mesh_count++,
+                     .layout = layout.index,
+                     .indices_count = static_cast<GLsizei>(mesh_indices),
+                     .indices_type = GL_UNSIGNED_INT,
+                     .first_index = static_cast<GLuint>(layout.index_count),
+                     .base_vertex = static_cast<GLint>(layout.vertex_count),
+                     .bounding_sphere = bounding_sphere(mesh)};
+
+    layout.vertex_count += mesh_vertices;
+    layout.index_count += mesh_indices;
+
+    auto append = [&registry = render_registry, layout_index = layout.index](Mesh const& data) {
+        registry.ctx().get<GeometryPool>().append(layout_index, data);
+    };
+
+    // Without the context the mesh is copied, as the caller may release it before the upload.
+    if (GlQueue::owns_context()) {
+        append(mesh);
+    } else {
+        GlQueue::submit([append, mesh] { append(mesh); });
+    }
+
+    return gpu_mesh;
+}
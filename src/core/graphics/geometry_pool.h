@@ -0,0 +1,103 @@
+#pragma once
+
+#include "buffer.h"
+#include "mesh.h"
+
+#include <entt/entity/fwd.hpp>
+#include <glad/gl.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+// Vertex and index storage shared by all meshes of one vertex layout. Indices are widened
+// to 32 bit so that every mesh of the buffer can be submitted with a single draw call.
+class GeometryBuffer
+{
+public:
+    explicit GeometryBuffer(VertexLayout const &layout);
+    ~GeometryBuffer();
+
+    GeometryBuffer(GeometryBuffer const &) = delete;
+    auto operator=(GeometryBuffer const &) -> GeometryBuffer & = delete;
+    GeometryBuffer(GeometryBuffer &&) = delete;
+    auto operator=(GeometryBuffer &&) -> GeometryBuffer & = delete;
+
+    // Stores the mesh behind the meshes appended before.
+    void append(Mesh const &mesh);
+    void attach_draw_id_buffer(GLuint draw_id_buffer) const;
+
+    [[nodiscard]] auto vao() const -> GLuint { return vertex_array; }
+
+private:
+    void reserve(std::size_t vertices, std::size_t indices);
+    void bind_attributes() const;
+
+    VertexLayout layout;
+
+    GLuint vertex_array{};
+    std::array<GLuint, VertexLayout::MAX_ATTRIBUTES> vertex_buffers{};
+    GLuint index_buffer{};
+
+    std::size_t vertex_count{};
+    std::size_t vertex_capacity{};
+    std::size_t index_count{};
+    std::size_t index_capacity{};
+};
+
+// Owns a GeometryBuffer per vertex layout, indexed by the dense layout index of the meshes.
+// Every vertex array object additionally sources a per-instance draw id from a shared buffer
+// counting upwards from zero, so that shaders can index per-draw data with the base instance of
+// a draw command. Only used by the thread owning the GL context.
+class GeometryPool
+{
+public:
+    static constexpr GLuint DRAW_ID_LOCATION = 4;
+    static constexpr std::size_t INITIAL_DRAW_IDS = 1024;
+
+    GeometryPool();
+
+    GeometryPool(GeometryPool const &) = delete;
+    auto operator=(GeometryPool const &) -> GeometryPool & = delete;
+    GeometryPool(GeometryPool &&) noexcept = default;
+    auto operator=(GeometryPool &&) noexcept -> GeometryPool & = default;
+    ~GeometryPool() = default;
+
+    // Layouts are indexed in the order of their first mesh, a new layout takes the next index.
+    void append(std::uint32_t layout_index, Mesh const &mesh);
+    void reserve_draw_ids(std::size_t count);
+
+    [[nodiscard]] auto vertex_array(std::uint32_t layout_index) const -> GLuint;
+
+private:
+    std::vector<std::unique_ptr<GeometryBuffer>> geometry_buffers;
+
+    Buffer draw_id_buffer{GL_ARRAY_BUFFER};
+    std::size_t draw_id_capacity{};
+};
+
+// Places meshes in the GeometryPool of the render registry. Where a mesh goes is decided right
+// away, while the upload runs on the thread owning the GL context, so that meshes can also be
+// uploaded while the render thread draws. Meshes are uploaded before the snapshot drawing them
+// is rendered.
+class GeometryUploader
+{
+public:
+    explicit GeometryUploader(entt::registry &render_registry) : render_registry(render_registry)
+    {
+    }
+
+    auto upload(Mesh const &mesh) -> GpuMesh;
+
+private:
+    struct Layout
+    {
+        std::uint32_t index;
+        std::size_t vertex_count{};
+        std::size_t index_count{};
+    };
+
+    entt::registry &render_registry;
+
+    std::map<VertexLayout, Layout> layouts;
+    std::uint32_t mesh_count{};
+};
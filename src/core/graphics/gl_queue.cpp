@@ -0,0 +1,42 @@
+#include "gl_queue.h"
+
+#include <GLFW/glfw3.h>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+std::mutex mutex;
+std::vector<GlQueue::Work> pending;
+
+} // namespace
+
+void GlQueue::submit(Work work)
+{
+    if (owns_context()) {
+        work();
+        return;
+    }
+
+    std::lock_guard const lock(mutex);
+    pending.push_back(std::move(work));
+}
+
+void GlQueue::execute()
+{
+    std::vector<Work> work;
+    {
+        std::lock_guard const lock(mutex);
+        work.swap(pending);
+    }
+
+    // Work may submit more work, which runs right away as the context is current.
+    for (auto& item : work) {
+        item();
+    }
+}
+
+auto GlQueue::owns_context() -> bool
+{
+    return glfwGetCurrentContext() != nullptr;
+}
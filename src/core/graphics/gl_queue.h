@@ -0,0 +1,26 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+
+// GL work of threads without the GL context, e.g. spawning entities while the render thread
+// draws. Work submitted by the thread the context is current on runs right away, other work runs
+// in submission order the next time that thread calls execute().
+namespace GlQueue {
+
+using Work = std::function<void()>;
+
+void submit(Work work);
+void execute();
+
+// Whether the GL context is current on the calling thread.
+[[nodiscard]] auto owns_context() -> bool;
+
+// Shares an object whose destructor releases GL objects, so that dropping the last reference on
+// any thread deletes it on the thread owning the context.
+template <typename T> auto share(T* object) -> std::shared_ptr<T>
+{
+    return std::shared_ptr<T>(object, [](T* shared) { submit([shared] { delete shared; }); });
+}
+
+} // namespace GlQueue
@@ -0,0 +1,306 @@
+#include "gl_state.h"
+
+#include <array>
+#include <optional>
+
+namespace {
+
+constexpr std::size_t MAX_TEXTURE_UNITS = 32;
+constexpr std::size_t MAX_INDEXED_BINDINGS = 16;
+
+// Buffer targets whose generic binding point is cached.
+constexpr std::array<GLenum, 8> BUFFER_TARGETS{GL_ARRAY_BUFFER,
+                                               GL_COPY_READ_BUFFER,
+                                               GL_COPY_WRITE_BUFFER,
+                                               GL_DRAW_INDIRECT_BUFFER,
+                                               GL_PIXEL_PACK_BUFFER,
+                                               GL_PIXEL_UNPACK_BUFFER,
+                                               GL_SHADER_STORAGE_BUFFER,
+                                               GL_UNIFORM_BUFFER};
+
+// Buffer targets with indexed binding points that are cached.
+constexpr std::array<GLenum, 2> INDEXED_BUFFER_TARGETS{GL_SHADER_STORAGE_BUFFER,
+                                                       GL_UNIFORM_BUFFER};
+
+// Binding of an indexed binding point. A size of zero binds the whole buffer.
+struct BufferRange
+{
+    GLuint buffer{};
+    GLintptr offset{};
+    GLsizeiptr size{};
+
+    auto operator==(BufferRange const&) const -> bool = default;
+};
+
+// An empty optional means the state is unknown. A freshly created context has everything
+// bound to zero and fills polygons.
+struct State
+{
+    std::optional<GLuint> program{0};
+    std::optional<GLuint> vertex_array{0};
+    std::optional<GLuint> active_texture_unit{0};
+    std::array<std::optional<GLuint>, MAX_TEXTURE_UNITS> textures;
+    std::array<std::optional<GLuint>, BUFFER_TARGETS.size()> buffers;
+    std::array<std::array<std::optional<BufferRange>, MAX_INDEXED_BINDINGS>,
+               INDEXED_BUFFER_TARGETS.size()>
+        indexed_buffers;
+    std::optional<GLuint> framebuffer{0};
+    std::optional<GLenum> polygon_mode{GL_FILL};
+
+    State()
+    {
+        textures.fill(0);
+        buffers.fill(0);
+        for (auto& bindings : indexed_buffers) {
+            bindings.fill(BufferRange{});
+        }
+    }
+};
+
+State cached;
+GlState::Stats counters;
+
+template <std::size_t N>
+auto target_index(std::array<GLenum, N> const& targets, GLenum target) -> std::optional<std::size_t>
+{
+    for (std::size_t i = 0; i < N; ++i) {
+        if (targets[i] == target) {
+            return i;
+        }
+    }
+
+    return {};
+}
+
+// Updates a cached binding and returns whether the GL call has to be issued.
+template <typename T>
+auto update(std::optional<T>& cached, T value, GlState::Counter& counter) -> bool
+{
+    if (cached == value) {
+        ++counter.elided;
+        return false;
+    }
+
+    cached = value;
+    ++counter.issued;
+    return true;
+}
+
+} // namespace
+
+void GlState::use_program(GLuint program)
+{
+    if (update(cached.program, program, counters.programs)) {
+        glUseProgram(program);
+    }
+}
+
+void GlState::bind_vertex_array(GLuint vertex_array)
+{
+    if (update(cached.vertex_array, vertex_array, counters.vertex_arrays)) {
+        glBindVertexArray(vertex_array);
+    }
+}
+
+void GlState::bind_texture(GLuint unit, GLuint texture, GLenum target)
+{
+    if (unit >= MAX_TEXTURE_UNITS) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        cached.active_texture_unit = unit;
+        ++counters.textures.issued;
+        return;
+    }
+
+    if (!update(cached.textures.at(unit), texture, counters.textures)) {
+        return;
+    }
+
+    if (cached.active_texture_unit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        cached.active_texture_unit = unit;
+    }
+
+    glBindTexture(target, texture);
+}
+
+void GlState::bind_buffer(GLenum target, GLuint buffer)
+{
+    auto index = target_index(BUFFER_TARGETS, target);
+
+    if (!index.has_value()) {
+        glBindBuffer(target, buffer);
+        ++counters.buffers.issued;
+        return;
+    }
+
+    if (update(cached.buffers.at(index.value()), buffer, counters.buffers)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+// Updates a cached indexed binding and returns whether the GL call has to be issued.
+static auto update_indexed(GLenum target, GLuint index, BufferRange const& range) -> bool
+{
+    auto target_slot = target_index(INDEXED_BUFFER_TARGETS, target);
+
+    if (target_slot.has_value() && index < MAX_INDEXED_BINDINGS) {
+        auto& cached_range = cached.indexed_buffers.at(target_slot.value()).at(index);
+
+        if (!update(cached_range, range, counters.buffers)) {
+            return false;
+        }
+    } else {
+        ++counters.buffers.issued;
+    }
+
+    // Indexed binds also bind the generic binding point.
+    if (auto generic_slot = target_index(BUFFER_TARGETS, target)) {
+        cached.buffers.at(generic_slot.value()) = range.buffer;
+    }
+
+    return true;
+}
+
+void GlState::bind_buffer_base(GLenum target, GLuint index, GLuint buffer)
+{
+    if (update_indexed(target, index, BufferRange{.buffer = buffer})) {
+        glBindBufferBase(target, index, buffer);
+    }
+}
+
+void GlState::bind_buffer_range(GLenum target,
+                                GLuint index,
+                                GLuint buffer,
+                                GLintptr offset,
+                                GLsizeiptr size)
+{
+    if (update_indexed(
+            target, index, BufferRange{.buffer = buffer, .offset = offset, .size = size})) {
+        glBindBufferRange(target, index, buffer, offset, size);
+    }
+}
+
+void GlState::bind_framebuffer(GLuint framebuffer)
+{
+    if (update(cached.framebuffer, framebuffer, counters.framebuffers)) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+}
+
+auto GlState::framebuffer() -> GLuint
+{
+    if (!cached.framebuffer.has_value()) {
+        // Only reached after the cache has been invalidated.
+        GLint framebuffer{};
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+        cached.framebuffer = static_cast<GLuint>(framebuffer);
+    }
+
+    return cached.framebuffer.value();
+}
+
+void GlState::polygon_mode(GLenum mode)
+{
+    if (update(cached.polygon_mode, mode, counters.polygon_modes)) {
+        glPolygonMode(GL_FRONT_AND_BACK, mode);
+    }
+}
+
+auto GlState::polygon_mode() -> GLenum
+{
+    if (!cached.polygon_mode.has_value()) {
+        // Only reached after the cache has been invalidated.
+        GLint mode{};
+        glGetIntegerv(GL_POLYGON_MODE, &mode);
+        cached.polygon_mode = static_cast<GLenum>(mode);
+    }
+
+    return cached.polygon_mode.value();
+}
+
+void GlState::delete_program(GLuint program)
+{
+    // A program is only deleted once it is no longer in use.
+    if (program != 0 && cached.program == program) {
+        use_program(0);
+    }
+
+    glDeleteProgram(program);
+}
+
+void GlState::delete_vertex_array(GLuint vertex_array)
+{
+    if (vertex_array != 0 && cached.vertex_array == vertex_array) {
+        cached.vertex_array = 0;
+    }
+
+    glDeleteVertexArrays(1, &vertex_array);
+}
+
+void GlState::delete_texture(GLuint texture)
+{
+    if (texture != 0) {
+        for (auto& bound_texture : cached.textures) {
+            if (bound_texture == texture) {
+                bound_texture = 0;
+            }
+        }
+    }
+
+    glDeleteTextures(1, &texture);
+}
+
+void GlState::delete_buffer(GLuint buffer)
+{
+    if (buffer != 0) {
+        for (auto& bound_buffer : cached.buffers) {
+            if (bound_buffer == buffer) {
+                bound_buffer = 0;
+            }
+        }
+
+        for (auto& bindings : cached.indexed_buffers) {
+            for (auto& bound_range : bindings) {
+                if (bound_range.has_value() && bound_range->buffer == buffer) {
+                    bound_range = BufferRange{};
+                }
+            }
+        }
+    }
+
+    glDeleteBuffers(1, &buffer);
+}
+
+void GlState::delete_framebuffer(GLuint framebuffer)
+{
+    if (framebuffer != 0 && cached.framebuffer == framebuffer) {
+        cached.framebuffer = 0;
+    }
+
+    glDeleteFramebuffers(1, &framebuffer);
+}
+
+void GlState::invalidate()
+{
+    cached.program.reset();
+    cached.vertex_array.reset();
+    cached.active_texture_unit.reset();
+    cached.textures.fill(std::nullopt);
+    cached.buffers.fill(std::nullopt);
+    for (auto& bindings : cached.indexed_buffers) {
+        bindings.fill(std::nullopt);
+    }
+    cached.framebuffer.reset();
+    cached.polygon_mode.reset();
+}
+
+auto GlState::stats() -> Stats const&
+{
+    return counters;
+}
+
+void GlState::reset_stats()
+{
+    counters = {};
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <glad/gl.h>
+
+// Shadow copy of the binding state of the current OpenGL context. All binds go through these
+// functions, which skip calls that would not change the state and never query the driver.
+// Objects have to be deleted through here as well, as GL resets bindings of deleted objects
+// and their names may be reused afterwards.
+namespace GlState {
+
+struct Counter
+{
+    unsigned issued{};
+    unsigned elided{};
+};
+
+struct Stats
+{
+    Counter programs;
+    Counter vertex_arrays;
+    Counter textures;
+    Counter buffers;
+    Counter framebuffers;
+    Counter polygon_modes;
+};
+
+void use_program(GLuint program);
+void bind_vertex_array(GLuint vertex_array);
+
+// Binds a texture to the given texture unit. Only the last texture bound to a unit is cached,
+// which is sufficient as a texture name always refers to a texture of the same target.
+void bind_texture(GLuint unit, GLuint texture, GLenum target = GL_TEXTURE_2D);
+
+// GL_ELEMENT_ARRAY_BUFFER is part of the vertex array state and is not cached.
+void bind_buffer(GLenum target, GLuint buffer);
+void bind_buffer_base(GLenum target, GLuint index, GLuint buffer);
+void bind_buffer_range(GLenum target,
+                       GLuint index,
+                       GLuint buffer,
+                       GLintptr offset,
+                       GLsizeiptr size);
+
+void bind_framebuffer(GLuint framebuffer);
+[[nodiscard]] auto framebuffer() -> GLuint;
+
+void polygon_mode(GLenum mode);
+[[nodiscard]] auto polygon_mode() -> GLenum;
+
+void delete_program(GLuint program);
+void delete_vertex_array(GLuint vertex_array);
+void delete_texture(GLuint texture);
+void delete_buffer(GLuint buffer);
+void delete_framebuffer(GLuint framebuffer);
+
+// Forgets the cached state, e.g. after foreign code changed bindings behind our back.
+void invalidate();
+
+[[nodiscard]] auto stats() -> Stats const &;
+void reset_stats();
+
+} // namespace GlState
@@ -0,0 +1,121 @@
+#include "gpu_profiler.h"
+
+#include <limits>
+
+namespace {
+
+constexpr auto NO_QUERY = std::numeric_limits<std::size_t>::max();
+
+} // namespace
+
+GpuProfiler::Scope::Scope(GpuProfiler& profiler, std::string_view name)
+    : profiler(profiler), end_query(NO_QUERY)
+{
+    glPushDebugGroup(
+        GL_DEBUG_SOURCE_APPLICATION, 0, static_cast<GLsizei>(name.size()), name.data());
+
+    if (profiler.recording) {
+        auto& slot = profiler.slots.at(profiler.frame % FRAME_LATENCY);
+
+        std::size_t begin_query = profiler.query(slot);
+        end_query = profiler.query(slot);
+        slot.scopes.push_back(PendingScope{.name = std::string(name),
+                                           .depth = profiler.depth,
+                                           .begin_query = begin_query,
+                                           .end_query = end_query});
+
+        glQueryCounter(slot.queries[begin_query], GL_TIMESTAMP);
+    }
+
+    ++profiler.depth;
+}
+
+GpuProfiler::Scope::~Scope()
+{
+    --profiler.depth;
+
+    if (end_query != NO_QUERY) {
+        auto& slot = profiler.slots.at(profiler.frame % FRAME_LATENCY);
+        glQueryCounter(slot.queries[end_query], GL_TIMESTAMP);
+    }
+
+    glPopDebugGroup();
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    for (auto& slot : slots) {
+        glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+    }
+}
+
+void GpuProfiler::begin_frame()
+{
+    auto& slot = slots.at(frame % FRAME_LATENCY);
+
+    recording = !slot.pending || collect(slot);
+    if (!recording) {
+        ++dropped_frame_count;
+        return;
+    }
+
+    slot.frame = frame;
+    slot.used_queries = 0;
+    slot.scopes.clear();
+}
+
+void GpuProfiler::end_frame()
+{
+    auto& slot = slots.at(frame % FRAME_LATENCY);
+    slot.pending = recording && !slot.scopes.empty();
+    ++frame;
+}
+
+auto GpuProfiler::query(FrameSlot& slot) -> std::size_t
+{
+    if (slot.used_queries == slot.queries.size()) {
+        GLuint query{};
+        glGenQueries(1, &query);
+        slot.queries.push_back(query);
+    }
+
+    return slot.used_queries++;
+}
+
+auto GpuProfiler::collect(FrameSlot& slot) -> bool
+{
+    // Queries complete in order, so all results are there once the last one is.
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(slot.queries[slot.used_queries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_FALSE) {
+        return false;
+    }
+
+    slot.pending = false;
+
+    // Frames are collected out of order when one was dropped.
+    if (slot.frame < latest_frame.frame) {
+        return true;
+    }
+
+    latest_frame.frame = slot.frame;
+    latest_frame.timings.clear();
+    latest_frame.milliseconds = 0.0F;
+
+    for (auto const& scope : slot.scopes) {
+        GLuint64 begin{};
+        GLuint64 end{};
+        glGetQueryObjectui64v(slot.queries[scope.begin_query], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(slot.queries[scope.end_query], GL_QUERY_RESULT, &end);
+
+        float milliseconds = static_cast<float>(end - begin) / 1e6F;
+        latest_frame.timings.push_back(
+            Timing{.name = scope.name, .depth = scope.depth, .milliseconds = milliseconds});
+
+        if (scope.depth == 0) {
+            latest_frame.milliseconds += milliseconds;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glad/gl.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Measures the GPU time of nested scopes with timestamp queries. Results are read a few frames
+// later, once the GPU has passed them, so reading never stalls. Scopes also push debug groups,
+// so captures of graphics debuggers are structured like the timings.
+class GpuProfiler
+{
+public:
+    // Frames in flight before the queries of a frame are reused. A frame whose queries are
+    // still unavailable by then is not measured.
+    static constexpr std::size_t FRAME_LATENCY = 4;
+
+    struct Timing
+    {
+        std::string name;
+        unsigned depth;
+        float milliseconds;
+    };
+
+    // Timings of the latest frame whose results arrived, in the order the scopes began.
+    struct Frame
+    {
+        std::uint64_t frame{};
+        std::vector<Timing> timings;
+
+        // Sum of the outermost scopes, which excludes the time the GPU waited for commands
+        // between them.
+        float milliseconds{};
+    };
+
+    class Scope
+    {
+    public:
+        Scope(GpuProfiler& profiler, std::string_view name);
+        ~Scope();
+
+        Scope(Scope const&) = delete;
+        auto operator=(Scope const&) -> Scope& = delete;
+        Scope(Scope&&) = delete;
+        auto operator=(Scope&&) -> Scope& = delete;
+
+    private:
+        GpuProfiler& profiler;
+        std::size_t end_query;
+    };
+
+    GpuProfiler() = default;
+    ~GpuProfiler();
+
+    GpuProfiler(GpuProfiler const&) = delete;
+    auto operator=(GpuProfiler const&) -> GpuProfiler& = delete;
+    GpuProfiler(GpuProfiler&&) = delete;
+    auto operator=(GpuProfiler&&) -> GpuProfiler& = delete;
+
+    void begin_frame();
+    void end_frame();
+
+    [[nodiscard]] auto latest() const -> Frame const& { return latest_frame; }
+    [[nodiscard]] auto dropped_frames() const -> std::uint64_t { return dropped_frame_count; }
+
+private:
+    struct PendingScope
+    {
+        std::string name;
+        unsigned depth;
+        std::size_t begin_query;
+        std::size_t end_query;
+    };
+
+    struct FrameSlot
+    {
+        std::uint64_t frame{};
+
+        // Grows to the largest number of queries a frame used
+        std::vector<GLuint> queries;
+        std::size_t used_queries{};
+
+        std::vector<PendingScope> scopes;
+        bool pending{};
+    };
+
+    auto query(FrameSlot& slot) -> std::size_t;
+    auto collect(FrameSlot& slot) -> bool;
+
+    std::array<FrameSlot, FRAME_LATENCY> slots;
+    std::uint64_t frame{};
+    unsigned depth{};
+    bool recording{};
+
+    Frame latest_frame;
+    std::uint64_t dropped_frame_count{};
+};
@@ -45,6 +45,14 @@ Image::Image(std::span<uint8_t const> bytes, ColorFormat colorFormat) : colorFor
     stbi_image_free(stbi_image);
 }
 
+Image::Image(Extent extent,
+             std::vector<uint8_t> pixels,
+             DataFormat dataFormat,
+             ColorFormat colorFormat) :
+    data(std::move(pixels)), extent(extent), dataFormat(dataFormat), colorFormat(colorFormat)
+{
+}
+
 GpuImage::GpuImage(Image const& image)
 {
     GLenum internalFormat{};
@@ -67,7 +75,7 @@ GpuImage::GpuImage(Image const& image)
     }
 
     glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    GlState::bind_texture(0, texture);
 
     glTexParameteri(
         GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(image.sampler.magFilter));
@@ -89,6 +97,4 @@ GpuImage::GpuImage(Image const& image)
                  image.data.data());
 
     glGenerateMipmap(GL_TEXTURE_2D);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
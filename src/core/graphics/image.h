@@ -1,5 +1,7 @@
 #pragma once
 
+#include "gl_state.h"
+
 #include <filesystem>
 #include <glad/gl.h>
 #include <span>
@@ -63,12 +65,20 @@ struct Image
     } colorFormat;
 
     Image(std::span<uint8_t const> bytes, ColorFormat colorFormat);
+
+    // Wraps already decoded pixels, e.g. generated ones.
+    Image(Extent extent,
+          std::vector<uint8_t> pixels,
+          DataFormat dataFormat,
+          ColorFormat colorFormat);
 };
 
 struct GpuImage
 {
     static constexpr float LOD_BIAS = -2.0;
 
+    // Holds no texture until one is moved in.
+    GpuImage() = default;
     GpuImage(Image const &image);
 
     GpuImage(GpuImage const &) = delete;
@@ -77,14 +87,14 @@ struct GpuImage
     GpuImage(GpuImage &&other) noexcept : texture(other.texture) { other.texture = 0; }
     auto operator=(GpuImage &&other) noexcept -> GpuImage &
     {
-        glDeleteTextures(1, &texture);
+        GlState::delete_texture(texture);
         
         texture = other.texture;
         other.texture = 0;
         return *this;
     };
 
-    ~GpuImage() { glDeleteTextures(1, &texture); };
+    ~GpuImage() { GlState::delete_texture(texture); };
 
     GLuint texture{};
 };
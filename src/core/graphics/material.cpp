@@ -1,32 +1,47 @@
 #include "material.h"
 #include "core/shader.h"
+#include "gl_queue.h"
+#include "gl_state.h"
 
-GpuMaterial::GpuMaterial(Material const& material) : shader(material.shader)
+#include <atomic>
+
+// Materials may be created by loader jobs off the main thread.
+static std::atomic<std::uint32_t> gpu_material_count = 0;
+
+// The texture is created and deleted on the thread owning the GL context, the material itself
+// may be created without it.
+static auto upload(entt::resource<Image> const& image) -> std::shared_ptr<GpuImage>
 {
-    int texture_unit_counter = 0;
+    auto texture = GlQueue::share(new GpuImage);
+    GlQueue::submit([texture, image] { *texture = GpuImage(*image); });
+    return texture;
+}
 
+GpuMaterial::GpuMaterial(Material const& material) :
+    id(gpu_material_count.fetch_add(1, std::memory_order_relaxed)), shader(material.shader)
+{
     if (material.base_color_texture.has_value()) {
-        Binding binding{.uniform_name = "u_material.texture_diffuse",
-                        .texture_unit = texture_unit_counter++};
-        base_color_texture = std::make_pair(GpuImage(material.base_color_texture.value()), binding);
+        base_color_texture = upload(material.base_color_texture.value());
     }
 
     if (material.normal_map_texture.has_value()) {
-        Binding binding{.uniform_name = "u_material.texture_normal",
-                        .texture_unit = texture_unit_counter++};
-        normal_map_texture = std::make_pair(GpuImage(material.normal_map_texture.value()), binding);
+        normal_map_texture = upload(material.normal_map_texture.value());
     }
 }
+
 void GpuMaterial::bind() const
 {
-    auto bind_texture = [this](auto const& texture) {
-        if (texture.has_value()) {
-            shader->set_uniform(texture->second.uniform_name, texture->second.texture_unit);
-            glActiveTexture(GL_TEXTURE0 + texture->second.texture_unit);
-            glBindTexture(GL_TEXTURE_2D, texture->first.texture);
-        }
-    };
-
-    bind_texture(base_color_texture);
-    bind_texture(normal_map_texture);
+    if (base_color_texture) {
+        GlState::bind_texture(BASE_COLOR_TEXTURE_UNIT, base_color_texture->texture);
+    }
+
+    if (normal_map_texture) {
+        GlState::bind_texture(NORMAL_MAP_TEXTURE_UNIT, normal_map_texture->texture);
+    }
+}
+
+auto GpuMaterial::texture_count() const -> unsigned
+{
+    return static_cast<unsigned>(base_color_texture != nullptr) +
+           static_cast<unsigned>(normal_map_texture != nullptr);
 }
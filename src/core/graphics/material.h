@@ -4,6 +4,7 @@
 #include "core/shader.h"
 
 #include <entt/entt.hpp>
+#include <memory>
 #include <optional>
 
 class Shader;
@@ -17,20 +18,25 @@ struct Material
     entt::resource<Shader> shader;
 };
 
+// Textures are shared between all copies of a GpuMaterial, so that entities using the same
+// material also bind the same texture objects. Copies also share the id.
 struct GpuMaterial
 {
+    // Texture units as given by the sampler bindings of the material shaders.
+    static constexpr GLuint BASE_COLOR_TEXTURE_UNIT = 0;
+    static constexpr GLuint NORMAL_MAP_TEXTURE_UNIT = 1;
+
     GpuMaterial(Material const &material);
 
+    // Binds the textures of the material. As the texture units are fixed, this is independent
+    // of the program the material is drawn with.
     void bind() const;
+    [[nodiscard]] auto texture_count() const -> unsigned;
 
-    struct Binding
-    {
-        std::string uniform_name;
-        int texture_unit;
-    };
+    std::uint32_t id;
 
-    std::optional<std::pair<GpuImage, Binding>> base_color_texture;
-    std::optional<std::pair<GpuImage, Binding>> normal_map_texture;
+    std::shared_ptr<GpuImage> base_color_texture;
+    std::shared_ptr<GpuImage> normal_map_texture;
 
     entt::resource<Shader> shader;
 };
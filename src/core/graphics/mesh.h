@@ -1,8 +1,10 @@
 #pragma once
 
 #include <array>
+#include <compare>
 #include <cstdint>
 #include <glad/gl.h>
+#include <glm/glm.hpp>
 #include <map>
 #include <variant>
 #include <vector>
@@ -38,38 +40,40 @@ struct Mesh
     Indices indices;
 };
 
-struct GpuMesh
+// Component counts of the vertex attributes of a mesh, indexed by attribute location. Meshes
+// with the same layout can share a vertex array object.
+struct VertexLayout
 {
-    GpuMesh(Mesh const &mesh);
+    static constexpr std::size_t MAX_ATTRIBUTES = 4;
 
-    GpuMesh(GpuMesh const &) = delete;
-    auto operator=(GpuMesh const &) -> GpuMesh & = delete;
+    std::array<GLint, MAX_ATTRIBUTES> components{};
 
-    GpuMesh(GpuMesh &&other) noexcept
-        : vao(other.vao), indices_count(other.indices_count), indices_type(other.indices_type)
-    {
-        other.vao = 0;
-    }
-    
-    auto operator=(GpuMesh &&other) noexcept -> GpuMesh &
-    {
-        glDeleteVertexArrays(1, &vao);
-        
-        vao = other.vao;
-        indices_count = other.indices_count;
-        indices_type = other.indices_type;
+    static auto of(Mesh const &mesh) -> VertexLayout;
 
-        // Deinitialize other
-        other.vao = 0;
-        
-        return *this;
-    };
+    auto operator<=>(VertexLayout const &) const = default;
+};
 
-    ~GpuMesh() { glDeleteVertexArrays(1, &vao); };
+// A mesh residing in the shared buffers of a GeometryPool. It is drawn with the vertex array
+// object of its layout, which is shared with all meshes of the same vertex layout.
+struct GpuMesh
+{
+    std::uint32_t id{};
 
-    // TODO: also store vertex buffers.
-    GLuint vao{};
+    // Dense index of the vertex layout in the pool, in the order the layouts were first uploaded
+    std::uint32_t layout{};
 
     GLsizei indices_count{};
-    GLenum indices_type{};
+    GLenum indices_type = GL_UNSIGNED_INT;
+
+    GLuint first_index{};
+    GLint base_vertex{};
+
+    // Model space bounds, xyz: center, w: radius.
+    glm::vec4 bounding_sphere{};
+
+    [[nodiscard]] auto indices_offset() const -> void const *
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast, performance-no-int-to-ptr)
+        return reinterpret_cast<void const *>(std::uintptr_t{first_index} * sizeof(GLuint));
+    }
 };
@@ -0,0 +1,131 @@
+#include "ring_buffer.h"
+#include "gl_state.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+static constexpr GLbitfield MAPPING_FLAGS =
+    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+// Nanoseconds to block in glClientWaitSync before trying again.
+static constexpr GLuint64 FENCE_TIMEOUT = 1'000'000;
+
+RingBuffer::RingBuffer()
+{
+    GLint uniform_alignment{};
+    GLint storage_alignment{};
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_alignment);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storage_alignment);
+
+    alignment = std::max(uniform_alignment, storage_alignment);
+}
+
+RingBuffer::~RingBuffer()
+{
+    for (GLsync fence : fences) {
+        glDeleteSync(fence);
+    }
+
+    // Deleting a buffer also unmaps it.
+    GlState::delete_buffer(buffer_object);
+}
+
+RingBuffer::RingBuffer(RingBuffer&& other) noexcept
+    : buffer_object(std::exchange(other.buffer_object, 0)),
+      mapping(std::exchange(other.mapping, nullptr)),
+      alignment(other.alignment),
+      region_size(std::exchange(other.region_size, 0)),
+      region_head(std::exchange(other.region_head, 0)),
+      frame(other.frame),
+      fences(std::exchange(other.fences, {}))
+{
+}
+
+auto RingBuffer::operator=(RingBuffer&& other) noexcept -> RingBuffer&
+{
+    for (GLsync fence : fences) {
+        glDeleteSync(fence);
+    }
+    GlState::delete_buffer(buffer_object);
+
+    buffer_object = std::exchange(other.buffer_object, 0);
+    mapping = std::exchange(other.mapping, nullptr);
+    alignment = other.alignment;
+    region_size = std::exchange(other.region_size, 0);
+    region_head = std::exchange(other.region_head, 0);
+    frame = other.frame;
+    fences = std::exchange(other.fences, {});
+
+    return *this;
+}
+
+void RingBuffer::begin_frame(GLsizeiptr size)
+{
+    frame = (frame + 1) % FRAMES_IN_FLIGHT;
+    region_head = 0;
+
+    if (size > region_size) {
+        // The regions of all frames move, so every frame in flight has to finish first.
+        for (GLsync& fence : fences) {
+            wait(fence);
+        }
+
+        recreate(std::max(size, region_size * 2));
+        return;
+    }
+
+    wait(fences.at(frame));
+}
+
+void RingBuffer::end_frame()
+{
+    glDeleteSync(fences.at(frame));
+    fences.at(frame) = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+auto RingBuffer::allocate(GLsizeiptr size) -> Allocation
+{
+    assert(region_head + size <= region_size);
+
+    GLintptr const offset = static_cast<GLsizeiptr>(frame) * region_size + region_head;
+    region_head += aligned(size);
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    return Allocation{.offset = offset, .size = size, .data = mapping + offset};
+}
+
+auto RingBuffer::aligned(GLsizeiptr size) const -> GLsizeiptr
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+void RingBuffer::recreate(GLsizeiptr new_region_size)
+{
+    GlState::delete_buffer(buffer_object);
+
+    region_size = aligned(new_region_size);
+    auto const buffer_size = region_size * static_cast<GLsizeiptr>(FRAMES_IN_FLIGHT);
+
+    glGenBuffers(1, &buffer_object);
+    GlState::bind_buffer(GL_COPY_WRITE_BUFFER, buffer_object);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, buffer_size, nullptr, MAPPING_FLAGS);
+
+    mapping = static_cast<std::byte*>(
+        glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, buffer_size, MAPPING_FLAGS));
+}
+
+void RingBuffer::wait(GLsync& fence)
+{
+    if (fence == nullptr) {
+        return;
+    }
+
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    while (result == GL_TIMEOUT_EXPIRED) {
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <glad/gl.h>
+
+// Persistently mapped buffer for data that is rewritten every frame. The buffer is split into
+// one region per frame in flight. A fence guards every region, so the CPU only waits when it
+// would overwrite data the GPU has not finished reading yet.
+class RingBuffer
+{
+public:
+    static constexpr std::size_t FRAMES_IN_FLIGHT = 3;
+
+    struct Allocation
+    {
+        GLintptr offset;
+        GLsizeiptr size;
+        void *data;
+    };
+
+    RingBuffer();
+    ~RingBuffer();
+
+    RingBuffer(RingBuffer const &) = delete;
+    auto operator=(RingBuffer const &) -> RingBuffer & = delete;
+    RingBuffer(RingBuffer &&other) noexcept;
+    auto operator=(RingBuffer &&other) noexcept -> RingBuffer &;
+
+    // Moves on to the region of the next frame and grows it to hold at least size bytes.
+    void begin_frame(GLsizeiptr size);
+
+    // Fences the region of the current frame. Call after the last draw reading from it.
+    void end_frame();
+
+    // Suballocates from the region of the current frame. The size has to be accounted for in
+    // the size passed to begin_frame() with aligned().
+    auto allocate(GLsizeiptr size) -> Allocation;
+
+    // Size including the padding to the offset alignment of uniform and storage buffers.
+    [[nodiscard]] auto aligned(GLsizeiptr size) const -> GLsizeiptr;
+
+    [[nodiscard]] auto buffer() const -> GLuint { return buffer_object; }
+
+private:
+    void recreate(GLsizeiptr new_region_size);
+    static void wait(GLsync& fence);
+
+    GLuint buffer_object{};
+    std::byte *mapping{};
+
+    GLsizeiptr alignment{};
+    GLsizeiptr region_size{};
+    GLsizeiptr region_head{};
+
+    std::size_t frame{};
+    std::array<GLsync, FRAMES_IN_FLIGHT> fences{};
+};
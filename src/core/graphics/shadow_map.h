@@ -0,0 +1,43 @@
+#pragma once
+
+#include "gl_state.h"
+
+#include <glad/gl.h>
+
+// Depth texture array with one layer per shadow cascade, sampled with depth comparison. A
+// second array caches the depth of the static casters of every cascade, so that updating a
+// cascade only has to copy its cached layer and draw the dynamic casters on top.
+class ShadowMap
+{
+public:
+    static constexpr GLuint TEXTURE_UNIT = 4;
+
+    ShadowMap(GLsizei resolution, GLsizei layers);
+    ~ShadowMap();
+
+    ShadowMap(ShadowMap const&) = delete;
+    auto operator=(ShadowMap const&) -> ShadowMap& = delete;
+
+    ShadowMap(ShadowMap&& other) noexcept;
+    auto operator=(ShadowMap&& other) noexcept -> ShadowMap&;
+
+    // Targets the static cache of a layer and clears it.
+    void begin_static(GLint layer) const;
+
+    // Copies the static cache of a layer into the shadow map and targets the layer to draw the
+    // dynamic casters.
+    void begin_dynamic(GLint layer) const;
+
+    void bind() const { GlState::bind_texture(TEXTURE_UNIT, shadow_texture, GL_TEXTURE_2D_ARRAY); }
+
+    [[nodiscard]] auto resolution() const -> GLsizei { return size; }
+
+private:
+    void release();
+
+    GLsizei size{};
+
+    GLuint shadow_texture{};
+    GLuint static_texture{};
+    GLuint frame_buffer{};
+};
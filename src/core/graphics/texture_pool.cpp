@@ -0,0 +1,179 @@
+#include "texture_pool.h"
+#include "gl_state.h"
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+static auto depth_attachment(GLenum internal_format) -> GLenum
+{
+    switch (internal_format) {
+    case GL_DEPTH24_STENCIL8:
+    case GL_DEPTH32F_STENCIL8:
+        return GL_DEPTH_STENCIL_ATTACHMENT;
+    default:
+        return GL_DEPTH_ATTACHMENT;
+    }
+}
+
+TexturePool::~TexturePool()
+{
+    for (auto const& framebuffer : framebuffers) {
+        GlState::delete_framebuffer(framebuffer.framebuffer);
+    }
+
+    for (auto const& texture : textures) {
+        GlState::delete_texture(texture.texture);
+    }
+}
+
+auto TexturePool::is_depth_format(GLenum internal_format) -> bool
+{
+    switch (internal_format) {
+    case GL_DEPTH_COMPONENT16:
+    case GL_DEPTH_COMPONENT24:
+    case GL_DEPTH_COMPONENT32F:
+    case GL_DEPTH24_STENCIL8:
+    case GL_DEPTH32F_STENCIL8:
+        return true;
+    default:
+        return false;
+    }
+}
+
+auto TexturePool::acquire(TextureDescription const& description) -> GLuint
+{
+    auto it = std::find_if(textures.begin(), textures.end(), [&description](auto const& texture) {
+        return !texture.in_use && texture.description == description;
+    });
+
+    if (it != textures.end()) {
+        it->in_use = true;
+        it->last_use = frame;
+        return it->texture;
+    }
+
+    GLuint texture{};
+    glGenTextures(1, &texture);
+
+    GlState::bind_texture(0, texture);
+    glTexStorage2D(GL_TEXTURE_2D,
+                   1,
+                   description.internal_format,
+                   static_cast<GLsizei>(description.dimensions.x),
+                   static_cast<GLsizei>(description.dimensions.y));
+
+    GLint filter = is_depth_format(description.internal_format) ? GL_NEAREST : GL_LINEAR;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    textures.push_back(
+        Texture{.texture = texture, .description = description, .in_use = true, .last_use = frame});
+
+    return texture;
+}
+
+void TexturePool::release(GLuint texture)
+{
+    auto it = std::find_if(textures.begin(), textures.end(), [texture](auto const& entry) {
+        return entry.texture == texture;
+    });
+
+    if (it != textures.end()) {
+        it->in_use = false;
+    }
+}
+
+void TexturePool::bind_framebuffer(std::span<GLuint const> attachments)
+{
+    auto it = std::find_if(framebuffers.begin(), framebuffers.end(), [attachments](auto const& fb) {
+        return std::equal(
+            fb.attachments.cbegin(), fb.attachments.cend(), attachments.begin(), attachments.end());
+    });
+
+    if (it != framebuffers.end()) {
+        it->last_use = frame;
+        GlState::bind_framebuffer(it->framebuffer);
+        return;
+    }
+
+    GLuint framebuffer{};
+    glGenFramebuffers(1, &framebuffer);
+    GlState::bind_framebuffer(framebuffer);
+
+    std::vector<GLenum> draw_buffers;
+    for (GLuint texture : attachments) {
+        GLenum internal_format = description(texture).internal_format;
+
+        GLenum attachment = is_depth_format(internal_format)
+                                ? depth_attachment(internal_format)
+                                : GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(draw_buffers.size());
+
+        if (attachment != GL_DEPTH_ATTACHMENT && attachment != GL_DEPTH_STENCIL_ATTACHMENT) {
+            draw_buffers.push_back(attachment);
+        }
+
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture, 0);
+    }
+
+    if (draw_buffers.empty()) {
+        glDrawBuffer(GL_NONE);
+    } else {
+        glDrawBuffers(static_cast<GLsizei>(draw_buffers.size()), draw_buffers.data());
+    }
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        spdlog::error("Render graph framebuffer not complete");
+    }
+
+    framebuffers.push_back(Framebuffer{.framebuffer = framebuffer,
+                                       .attachments = {attachments.begin(), attachments.end()},
+                                       .last_use = frame});
+}
+
+void TexturePool::end_frame()
+{
+    auto expired = [this](std::uint64_t last_use) { return frame - last_use >= EVICTION_FRAMES; };
+
+    std::vector<GLuint> evicted;
+    std::erase_if(textures, [&](auto const& texture) {
+        if (texture.in_use || !expired(texture.last_use)) {
+            return false;
+        }
+
+        evicted.push_back(texture.texture);
+        GlState::delete_texture(texture.texture);
+        return true;
+    });
+
+    // Framebuffers must not outlive their attachments, as the names of deleted textures are
+    // reused for new ones.
+    std::erase_if(framebuffers, [&](auto const& framebuffer) {
+        bool const stale = std::any_of(
+            framebuffer.attachments.cbegin(), framebuffer.attachments.cend(), [&](GLuint texture) {
+                return std::find(evicted.cbegin(), evicted.cend(), texture) != evicted.cend();
+            });
+
+        if (!stale && !expired(framebuffer.last_use)) {
+            return false;
+        }
+
+        GlState::delete_framebuffer(framebuffer.framebuffer);
+        return true;
+    });
+
+    ++frame;
+}
+
+auto TexturePool::description(GLuint texture) const -> TextureDescription const&
+{
+    return find(texture)->description;
+}
+
+auto TexturePool::find(GLuint texture) const -> std::vector<Texture>::const_iterator
+{
+    return std::find_if(textures.cbegin(), textures.cend(), [texture](auto const& entry) {
+        return entry.texture == texture;
+    });
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+// Format and size of a texture. Textures with equal descriptions are interchangeable.
+struct TextureDescription
+{
+    glm::u32vec2 dimensions;
+    GLenum internal_format;
+
+    auto operator==(TextureDescription const&) const -> bool = default;
+};
+
+// Recycles render target textures and the framebuffers combining them. A released texture is
+// handed out again for an equal description, within the same frame or a later one, and only
+// deleted once it has not been used for a few frames. Interleaved sizes, e.g. while a window
+// is resized, therefore do not reallocate every frame.
+class TexturePool
+{
+public:
+    static constexpr std::uint64_t EVICTION_FRAMES = 3;
+
+    TexturePool() = default;
+    ~TexturePool();
+
+    TexturePool(TexturePool const&) = delete;
+    auto operator=(TexturePool const&) -> TexturePool& = delete;
+    TexturePool(TexturePool&&) = delete;
+    auto operator=(TexturePool&&) -> TexturePool& = delete;
+
+    auto acquire(TextureDescription const& description) -> GLuint;
+    void release(GLuint texture);
+
+    // Binds a framebuffer with the given attachments of this pool, created on first use. Depth
+    // formats are attached as depth attachment, all other textures as color attachments.
+    void bind_framebuffer(std::span<GLuint const> attachments);
+
+    // Deletes textures and framebuffers that were not used for EVICTION_FRAMES frames.
+    void end_frame();
+
+    [[nodiscard]] auto description(GLuint texture) const -> TextureDescription const&;
+    [[nodiscard]] auto texture_count() const -> std::size_t { return textures.size(); }
+
+    [[nodiscard]] static auto is_depth_format(GLenum internal_format) -> bool;
+
+private:
+    struct Texture
+    {
+        GLuint texture;
+        TextureDescription description;
+        bool in_use;
+        std::uint64_t last_use;
+    };
+
+    struct Framebuffer
+    {
+        GLuint framebuffer;
+        std::vector<GLuint> attachments;
+        std::uint64_t last_use;
+    };
+
+    [[nodiscard]] auto find(GLuint texture) const -> std::vector<Texture>::const_iterator;
+
+    std::vector<Texture> textures;
+    std::vector<Framebuffer> framebuffers;
+    std::uint64_t frame{};
+};
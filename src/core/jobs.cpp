@@ -0,0 +1,461 @@
+#include "jobs.h"
+#include "util/profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace Jobs {
+
+class Job
+{
+public:
+    Job(Task task, Affinity affinity) : task(std::move(task)), affinity(affinity) {}
+
+    Task task;
+    Affinity affinity;
+
+    // Unfinished dependencies plus one held while the job is being scheduled
+    std::atomic<std::size_t> pending_dependencies{1};
+
+    std::mutex mutex;
+    std::vector<Handle> continuations;
+    std::atomic<bool> done{};
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t NO_THREAD = static_cast<std::size_t>(-1);
+
+// Attempts to find a job before a waiting thread blocks
+constexpr int WAIT_SPINS = 64;
+
+struct Worker
+{
+    std::mutex mutex;
+    std::deque<Handle> jobs;
+
+    std::atomic<std::uint64_t> executed{};
+    std::atomic<std::uint64_t> steals{};
+    std::atomic<std::int64_t> busy_nanoseconds{};
+};
+
+struct Pool
+{
+    // Index 0 is the main thread
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex main_thread_mutex;
+    std::deque<Handle> main_thread_jobs;
+    std::atomic<std::size_t> main_thread_queued{};
+
+    // Jobs in the worker deques, which idle workers sleep on
+    std::atomic<std::size_t> queued{};
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping{};
+
+    // Threads blocked in wait(), woken when a job finishes or new jobs are queued
+    std::atomic<std::size_t> waiting{};
+    std::condition_variable waiter_wake;
+
+    // Spreads jobs scheduled from threads outside of the pool
+    std::atomic<std::size_t> next_worker{};
+
+    Clock::time_point stats_reset{Clock::now()};
+};
+
+std::unique_ptr<Pool> pool;
+thread_local std::size_t current_thread = NO_THREAD;
+
+// Only takes the lock while a thread waits, so finishing jobs stays cheap otherwise.
+void wake_waiters()
+{
+    if (pool == nullptr || pool->waiting.load() == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard lock(pool->sleep_mutex);
+    }
+    pool->waiter_wake.notify_all();
+}
+
+void enqueue(Handle job)
+{
+    if (job->affinity == Affinity::MainThread) {
+        {
+            std::lock_guard lock(pool->main_thread_mutex);
+            pool->main_thread_jobs.push_back(std::move(job));
+        }
+        pool->main_thread_queued.fetch_add(1);
+        wake_waiters();
+        return;
+    }
+
+    std::size_t index = current_thread;
+    if (index == NO_THREAD) {
+        index = pool->next_worker.fetch_add(1, std::memory_order_relaxed) % pool->workers.size();
+    }
+
+    {
+        auto& worker = *pool->workers[index];
+        std::lock_guard lock(worker.mutex);
+        worker.jobs.push_back(std::move(job));
+    }
+
+    pool->queued.fetch_add(1);
+    {
+        // Taking the lock orders the increment before a worker checks it and goes to sleep.
+        std::lock_guard lock(pool->sleep_mutex);
+    }
+    pool->wake.notify_one();
+    wake_waiters();
+}
+
+void execute(Job& job, std::size_t thread);
+
+void release_dependency(Handle const& job)
+{
+    if (job->pending_dependencies.fetch_sub(1) != 1) {
+        return;
+    }
+
+    if (pool == nullptr) {
+        execute(*job, NO_THREAD);
+    } else {
+        enqueue(job);
+    }
+}
+
+void complete(Job& job)
+{
+    std::vector<Handle> continuations;
+    {
+        std::lock_guard lock(job.mutex);
+        job.done.store(true);
+        continuations = std::move(job.continuations);
+    }
+
+    wake_waiters();
+
+    for (auto const& continuation : continuations) {
+        release_dependency(continuation);
+    }
+}
+
+void execute(Job& job, std::size_t thread)
+{
+    auto const start = Clock::now();
+
+    job.task();
+    job.task = nullptr;
+
+    if (thread != NO_THREAD) {
+        auto& worker = *pool->workers[thread];
+        worker.executed.fetch_add(1, std::memory_order_relaxed);
+        worker.busy_nanoseconds.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count(),
+            std::memory_order_relaxed);
+    }
+
+    complete(job);
+}
+
+auto pop_main_thread_job() -> Handle
+{
+    std::lock_guard lock(pool->main_thread_mutex);
+    if (pool->main_thread_jobs.empty()) {
+        return nullptr;
+    }
+
+    Handle job = std::move(pool->main_thread_jobs.front());
+    pool->main_thread_jobs.pop_front();
+    pool->main_thread_queued.fetch_sub(1);
+    return job;
+}
+
+// Takes the newest job of the own deque, otherwise steals the oldest job of another one.
+auto find_job(std::size_t thread) -> Handle
+{
+    if (thread == 0) {
+        if (Handle job = pop_main_thread_job()) {
+            return job;
+        }
+    }
+
+    auto const worker_count = pool->workers.size();
+
+    if (thread != NO_THREAD) {
+        auto& worker = *pool->workers[thread];
+        std::lock_guard lock(worker.mutex);
+
+        if (!worker.jobs.empty()) {
+            Handle job = std::move(worker.jobs.back());
+            worker.jobs.pop_back();
+            pool->queued.fetch_sub(1);
+            return job;
+        }
+    }
+
+    std::size_t const first = thread == NO_THREAD ? 0 : thread + 1;
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        auto& victim = *pool->workers[(first + i) % worker_count];
+        std::lock_guard lock(victim.mutex);
+
+        if (!victim.jobs.empty()) {
+            Handle job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            pool->queued.fetch_sub(1);
+
+            if (thread != NO_THREAD) {
+                pool->workers[thread]->steals.fetch_add(1, std::memory_order_relaxed);
+            }
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+// Sleeps until the job finished or a job the calling thread could run was queued.
+void block(Job const& job)
+{
+    std::unique_lock lock(pool->sleep_mutex);
+
+    // Counted before checking, so that a job finishing in between sees the waiter.
+    pool->waiting.fetch_add(1);
+    pool->waiter_wake.wait(lock, [&job] {
+        return job.done.load() || pool->queued.load() != 0 ||
+               (current_thread == 0 && pool->main_thread_queued.load() != 0);
+    });
+    pool->waiting.fetch_sub(1);
+}
+
+void work(std::size_t thread)
+{
+    FEVER_PROFILE_THREAD("worker");
+    current_thread = thread;
+
+    while (true) {
+        if (Handle job = find_job(thread)) {
+            execute(*job, thread);
+            continue;
+        }
+
+        std::unique_lock lock(pool->sleep_mutex);
+        pool->wake.wait(lock, [] { return pool->stopping || pool->queued.load() != 0; });
+
+        if (pool->stopping && pool->queued.load() == 0) {
+            return;
+        }
+    }
+}
+
+} // namespace
+
+void start(std::size_t worker_threads)
+{
+    if (pool != nullptr) {
+        return;
+    }
+
+    if (worker_threads == 0) {
+        worker_threads = std::max(std::thread::hardware_concurrency(), 2U) - 1;
+    }
+
+    pool = std::make_unique<Pool>();
+    for (std::size_t i = 0; i <= worker_threads; ++i) {
+        pool->workers.push_back(std::make_unique<Worker>());
+    }
+
+    current_thread = 0;
+    for (std::size_t i = 1; i <= worker_threads; ++i) {
+        pool->threads.emplace_back(work, i);
+    }
+}
+
+void stop()
+{
+    if (pool == nullptr) {
+        return;
+    }
+
+    // Workers could wait for jobs of the main thread, which have to run before they finish.
+    while (Handle job = find_job(0)) {
+        execute(*job, 0);
+    }
+
+    {
+        std::lock_guard lock(pool->sleep_mutex);
+        pool->stopping = true;
+    }
+    pool->wake.notify_all();
+
+    for (auto& thread : pool->threads) {
+        thread.join();
+    }
+
+    // Continuations the workers scheduled last
+    while (Handle job = find_job(0)) {
+        execute(*job, 0);
+    }
+
+    pool.reset();
+    current_thread = NO_THREAD;
+}
+
+auto running() -> bool
+{
+    return pool != nullptr;
+}
+
+auto thread_count() -> std::size_t
+{
+    return pool != nullptr ? pool->workers.size() : 1;
+}
+
+auto schedule(Task task, std::span<Handle const> dependencies, Affinity affinity) -> Handle
+{
+    auto job = std::make_shared<Job>(std::move(task), affinity);
+
+    for (auto const& dependency : dependencies) {
+        std::lock_guard lock(dependency->mutex);
+
+        if (!dependency->done.load()) {
+            job->pending_dependencies.fetch_add(1);
+            dependency->continuations.push_back(job);
+        }
+    }
+
+    release_dependency(job);
+    return job;
+}
+
+auto then(Handle const& job, Task task, Affinity affinity) -> Handle
+{
+    return schedule(std::move(task), std::span(&job, 1), affinity);
+}
+
+auto finished(Handle const& job) -> bool
+{
+    return job->done.load();
+}
+
+void wait(Handle const& job)
+{
+    int spins = 0;
+    while (!job->done.load()) {
+        Handle other = pool != nullptr ? find_job(current_thread) : nullptr;
+
+        if (other != nullptr) {
+            execute(*other, current_thread);
+            spins = 0;
+        } else if (pool == nullptr || ++spins < WAIT_SPINS) {
+            std::this_thread::yield();
+        } else {
+            block(*job);
+            spins = 0;
+        }
+    }
+}
+
+void run_main_thread_jobs()
+{
+    if (pool == nullptr) {
+        return;
+    }
+
+    while (Handle job = pop_main_thread_job()) {
+        execute(*job, 0);
+    }
+}
+
+void parallel_for(std::size_t begin,
+                  std::size_t end,
+                  std::size_t grain,
+                  std::function<void(std::size_t, std::size_t)> const& function)
+{
+    if (begin >= end) {
+        return;
+    }
+
+    grain = std::max<std::size_t>(grain, 1);
+    std::size_t const chunks = (end - begin + grain - 1) / grain;
+
+    if (pool == nullptr || chunks == 1) {
+        function(begin, end);
+        return;
+    }
+
+    // Every participant takes chunks until none are left, which balances uneven chunks.
+    std::atomic<std::size_t> next_chunk{};
+    auto run_chunks = [&] {
+        for (std::size_t chunk = next_chunk.fetch_add(1); chunk < chunks;
+             chunk = next_chunk.fetch_add(1)) {
+            std::size_t const chunk_begin = begin + chunk * grain;
+            function(chunk_begin, std::min(chunk_begin + grain, end));
+        }
+    };
+
+    std::vector<Handle> helpers;
+    std::size_t const helper_count = std::min(chunks, pool->workers.size()) - 1;
+    helpers.reserve(helper_count);
+    for (std::size_t i = 0; i < helper_count; ++i) {
+        helpers.push_back(schedule(run_chunks));
+    }
+
+    run_chunks();
+
+    for (auto const& helper : helpers) {
+        wait(helper);
+    }
+}
+
+auto stats() -> std::vector<WorkerStats>
+{
+    if (pool == nullptr) {
+        return {};
+    }
+
+    auto const elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             Clock::now() - pool->stats_reset)
+                             .count();
+
+    std::vector<WorkerStats> stats;
+    for (auto const& worker : pool->workers) {
+        auto const busy = worker->busy_nanoseconds.load(std::memory_order_relaxed);
+
+        stats.push_back(WorkerStats{
+            .jobs = worker->executed.load(std::memory_order_relaxed),
+            .steals = worker->steals.load(std::memory_order_relaxed),
+            .utilization =
+                elapsed > 0 ? static_cast<float>(busy) / static_cast<float>(elapsed) : 0.0F});
+    }
+
+    return stats;
+}
+
+void reset_stats()
+{
+    if (pool == nullptr) {
+        return;
+    }
+
+    for (auto const& worker : pool->workers) {
+        worker->executed.store(0, std::memory_order_relaxed);
+        worker->steals.store(0, std::memory_order_relaxed);
+        worker->busy_nanoseconds.store(0, std::memory_order_relaxed);
+    }
+
+    pool->stats_reset = Clock::now();
+}
+
+} // namespace Jobs
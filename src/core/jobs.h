@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Work-stealing job system shared by all systems of the engine. Every thread of the pool owns a
+// deque, pushing and popping its own jobs at the back while idle threads steal from the front.
+// The thread that starts the pool owns the window. It takes part in the pool while it waits and
+// is the only thread running jobs with main thread affinity.
+//
+// Without a started pool, jobs run inline on the calling thread.
+namespace Jobs {
+
+using Task = std::function<void()>;
+
+class Job;
+using Handle = std::shared_ptr<Job>;
+
+enum class Affinity
+{
+    Any,
+    // For jobs calling into GLFW, or into OpenGL while no render thread owns the context. Run by
+    // run_main_thread_jobs() or while the main thread waits.
+    MainThread,
+};
+
+struct WorkerStats
+{
+    std::uint64_t jobs{};
+    std::uint64_t steals{};
+
+    // Fraction of the time since the last reset spent running jobs
+    float utilization{};
+};
+
+// Starts the pool with the calling thread as its main thread. By default, one worker thread is
+// started per hardware thread besides the main thread.
+void start(std::size_t worker_threads = 0);
+
+// Runs the remaining jobs and joins the worker threads.
+void stop();
+
+[[nodiscard]] auto running() -> bool;
+
+// Threads of the pool including the main thread
+[[nodiscard]] auto thread_count() -> std::size_t;
+
+// Schedules a task to run once all dependencies finished.
+auto schedule(Task task,
+              std::span<Handle const> dependencies = {},
+              Affinity affinity = Affinity::Any) -> Handle;
+
+// Schedules a continuation of a job.
+auto then(Handle const& job, Task task, Affinity affinity = Affinity::Any) -> Handle;
+
+[[nodiscard]] auto finished(Handle const& job) -> bool;
+
+// Runs other jobs until the job finished. Sleeps while there are none to run.
+void wait(Handle const& job);
+
+// Runs the queued jobs with main thread affinity. Call on the main thread once per frame.
+void run_main_thread_jobs();
+
+// Calls function(chunk_begin, chunk_end) for chunks of at most grain elements of the range,
+// spread over the pool. Returns when all chunks are done, the calling thread takes part.
+void parallel_for(std::size_t begin,
+                  std::size_t end,
+                  std::size_t grain,
+                  std::function<void(std::size_t, std::size_t)> const& function);
+
+// Index 0 is the main thread.
+[[nodiscard]] auto stats() -> std::vector<WorkerStats>;
+void reset_stats();
+
+} // namespace Jobs
@@ -1,19 +1,94 @@
 #include "light.h"
 #include "components/transform.h"
+#include "core/camera.h"
+#include "core/cluster_grid.h"
+#include "core/graphics/buffer.h"
+
+#include <spdlog/spdlog.h>
+#include <vector>
+
+namespace {
+
+// Light data of the frame as laid out in the LightBuffer of the standard material (std140).
+struct LightData
+{
+    glm::vec4 directional_light_direction;
+    glm::vec4 directional_light_color;
+    glm::uvec4 cluster_count;
+    glm::vec4 cluster_depth_params;
+};
+
+// Point light as laid out in the PointLightBuffer of the standard material (std430).
+struct GpuPointLight
+{
+    glm::vec4 position_radius;
+    glm::vec4 color;
+};
+
+struct LightContext
+{
+    static constexpr GLuint LIGHT_DATA_BINDING = 1;
+    static constexpr GLuint POINT_LIGHT_BINDING = 1;
+    static constexpr GLuint CLUSTER_BINDING = 2;
+    static constexpr GLuint LIGHT_INDEX_BINDING = 3;
+
+    Buffer light_data{GL_UNIFORM_BUFFER};
+    Buffer point_lights{GL_SHADER_STORAGE_BUFFER};
+    Buffer clusters{GL_SHADER_STORAGE_BUFFER};
+    Buffer light_indices{GL_SHADER_STORAGE_BUFFER};
+
+    ClusterGrid cluster_grid;
+
+    // Reused between frames to avoid reallocations.
+    std::vector<GpuPointLight> gpu_point_lights;
+    std::vector<ClusterGrid::Sphere> light_volumes;
+};
+
+} // namespace
 
 static auto light_active(float illuminance) -> bool
 {
     return std::abs(illuminance) >= std::numeric_limits<float>::epsilon();
 }
 
-static auto point_light_uniform_base(std::size_t n) -> std::string
+// Distance at which the attenuated intensity of a point light drops below the cutoff. The
+// shader fades the light out towards this distance.
+static auto light_radius(PointLight const &point_light) -> float
 {
-    return "u_pointLight[" + std::to_string(n) + "].";
+    auto const max_component =
+        std::max({point_light.color.r, point_light.color.g, point_light.color.b});
+    float const intensity = static_cast<float>(max_component) * point_light.intensity;
+
+    return std::sqrt(intensity / (PointLight::ATTENUATION_QUADRATIC * PointLight::CUTOFF));
 }
 
-void Light::update_lights(entt::registry &registry, Shader &shader)
+void Light::update_lights(entt::registry &registry)
 {
-    shader.bind();
+    auto camera_view = registry.view<Camera const, GlobalTransform const>();
+    auto camera_entity = camera_view.front();
+
+    if (camera_entity == entt::null) {
+        spdlog::debug("No camera entity found");
+        return;
+    }
+
+    auto [camera, camera_transform] = camera_view.get(camera_entity);
+    glm::mat4 view_matrix = Camera::view_matrix(camera_transform);
+    auto [near_plane, far_plane] = std::visit(
+        [](auto const &projection) { return std::pair(projection.near, projection.far); },
+        camera.projection);
+
+    auto &context = registry.ctx().emplace<LightContext>();
+    context.cluster_grid.set_projection(camera.projection_matrix(), near_plane, far_plane);
+
+    auto const& cluster_grid = context.cluster_grid;
+    LightData light_data{
+        .directional_light_direction = glm::vec4(0.0),
+        .directional_light_color = glm::vec4(0.0),
+        .cluster_count =
+            glm::uvec4(ClusterGrid::TILES_X, ClusterGrid::TILES_Y, ClusterGrid::SLICES, 0),
+        .cluster_depth_params =
+            glm::vec4(cluster_grid.depth_scale(), cluster_grid.depth_bias(), 0.0, 0.0)};
 
     // Directional light
     {
@@ -21,33 +96,57 @@ void Light::update_lights(entt::registry &registry, Shader &shader)
             registry.view<DirectionalLight const, GlobalTransform const>();
 
         entt::entity entity = directional_lights_view.front();
-        auto [directional_light, global_transform] = directional_lights_view.get(entity);
 
-        glm::vec4 unit_vector{1.0, 0.0, 0.0, 0.0};
-        glm::vec3 direction = glm::vec3(global_transform.transform * unit_vector);
+        if (entity != entt::null) {
+            auto [directional_light, global_transform] = directional_lights_view.get(entity);
 
-        shader.set_uniform("u_directionalLight.isActive",
-                           light_active(directional_light.illuminance));
-        shader.set_uniform("u_directionalLight.direction", direction);
-        shader.set_uniform("u_directionalLight.color",
-                           (directional_light.color * directional_light.illuminance).to_vec3());
+            glm::vec4 unit_vector{1.0, 0.0, 0.0, 0.0};
+            glm::vec3 direction = glm::vec3(global_transform.transform * unit_vector);
+
+            light_data.directional_light_direction =
+                glm::vec4(direction, light_active(directional_light.illuminance) ? 1.0 : 0.0);
+            light_data.directional_light_color = glm::vec4(
+                (directional_light.color * directional_light.illuminance).to_vec3(), 0.0);
+        }
     }
 
     // Point lights
     {
+        context.gpu_point_lights.clear();
+        context.light_volumes.clear();
+
         auto point_lights_view = registry.view<PointLight const, GlobalTransform const>();
-        std::size_t num = 0;
         for (auto [entity, point_light, global_transform] : point_lights_view.each()) {
-            shader.set_uniform((point_light_uniform_base(num) + "isActive").c_str(),
-                               light_active(point_light.intensity));
-            shader.set_uniform((point_light_uniform_base(num) + "position").c_str(),
-                               global_transform.position());
-            shader.set_uniform((point_light_uniform_base(num) + "color").c_str(),
-                               (point_light.color * point_light.intensity).to_vec3());
-
-            num++;
+            if (!light_active(point_light.intensity)) {
+                continue;
+            }
+
+            float radius = light_radius(point_light);
+            glm::vec3 position = global_transform.position();
+
+            context.gpu_point_lights.push_back(GpuPointLight{
+                .position_radius = glm::vec4(position, radius),
+                .color = glm::vec4((point_light.color * point_light.intensity).to_vec3(), 0.0)});
+
+            context.light_volumes.push_back(ClusterGrid::Sphere{
+                .center = glm::vec3(view_matrix * glm::vec4(position, 1.0)), .radius = radius});
         }
+
+        light_data.cluster_count.w = static_cast<std::uint32_t>(context.gpu_point_lights.size());
     }
 
-    Shader::unbind();
+    context.cluster_grid.assign(context.light_volumes);
+
+    auto ranges = context.cluster_grid.ranges();
+    auto indices = context.cluster_grid.light_indices();
+
+    context.light_data.upload(&light_data, sizeof(LightData));
+    context.point_lights.upload(context.gpu_point_lights);
+    context.clusters.upload(ranges.data(), static_cast<GLsizeiptr>(ranges.size_bytes()));
+    context.light_indices.upload(indices.data(), static_cast<GLsizeiptr>(indices.size_bytes()));
+
+    context.light_data.bind_base(LightContext::LIGHT_DATA_BINDING);
+    context.point_lights.bind_base(LightContext::POINT_LIGHT_BINDING);
+    context.clusters.bind_base(LightContext::CLUSTER_BINDING);
+    context.light_indices.bind_base(LightContext::LIGHT_INDEX_BINDING);
 }
@@ -1,7 +1,6 @@
 #pragma once
 
 #include "components/color.h"
-#include "core/shader.h"
 
 #include <entt/entt.hpp>
 #include <glm/glm.hpp>
@@ -11,6 +10,12 @@ struct PointLight
     static constexpr glm::vec3 DEFAULT_POSITION{4.0, 1.0, 6.0};
     static constexpr float DEFAULT_INTENSITY = 3.0;
 
+    // Must match the attenuation in the standard material.
+    static constexpr float ATTENUATION_QUADRATIC = 0.032;
+
+    // Intensity below which the light is cut off, which bounds the lights affecting a cluster.
+    static constexpr float CUTOFF = 0.02;
+
     Color color = ColorConstant::WHITE;
     float intensity{};
 };
@@ -25,5 +30,6 @@ struct DirectionalLight
 };
 
 namespace Light {
-void update_lights(entt::registry& registry, Shader& shader);
+// Uploads the lights of the scene and assigns the point lights to the clusters of the view.
+void update_lights(entt::registry& registry);
 }
@@ -1,45 +1,356 @@
 #include "render.h"
 #include "core/camera.h"
+#include "core/graphics/g_buffer.h"
+#include "core/graphics/geometry_pool.h"
+#include "core/graphics/gpu_profiler.h"
+#include "core/graphics/gl_state.h"
 #include "core/graphics/material.h"
 #include "core/graphics/mesh.h"
+#include "core/graphics/ring_buffer.h"
+#include "core/graphics/texture_pool.h"
+#include "core/render_queue.h"
 #include "core/shader.h"
 
+#include <algorithm>
+#include <optional>
+#include <span>
 #include <spdlog/spdlog.h>
+#include <vector>
+
+namespace {
+
+// Per-view data as laid out in the ViewBuffer of the standard material (std140).
+struct ViewData
+{
+    glm::mat4 view_matrix;
+    glm::mat4 projection_matrix;
+    glm::mat4 view_projection_matrix;
+    glm::mat4 inverse_view_matrix;
+    glm::mat4 inverse_projection_matrix;
+    glm::vec4 view_position;
+};
+
+// Per-draw data as laid out in the DrawDataBuffer of the standard material (std430).
+struct DrawData
+{
+    glm::mat4 model_matrix;
+};
+
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint base_vertex;
+    GLuint base_instance;
+};
+
+// Consecutive items drawing the same mesh with the same material. Their per-draw data is
+// stored consecutively, so they can be drawn as instances of a single draw.
+struct InstanceGroup
+{
+    std::size_t first;
+    std::size_t count;
+};
+
+struct RenderContext
+{
+    static constexpr GLuint VIEW_DATA_BINDING = 0;
+    static constexpr GLuint DRAW_DATA_BINDING = 0;
+
+    // View data, per-draw data and indirect commands of the frames in flight.
+    RingBuffer frame_data;
+
+    RenderQueue queue;
+
+    // Deferred path: the geometry pass shades all materials with the same program into the
+    // targets of the G-buffer.
+    Shader geometry_shader{
+        "standard_material", "deferred_geometry", ShaderLoader::shader_directory};
+    Shader lighting_shader{"post_processing", "deferred_lighting", ShaderLoader::shader_directory};
+    GBuffer g_buffer;
+
+    // Reused between frames to avoid reallocations.
+    std::vector<Shader const*> shaders;
+    std::vector<InstanceGroup> instance_groups;
+};
+
+// Sort key field of a mesh. Meshes are grouped by their vertex layout first, as only meshes
+// sharing the vertex array of a layout can be merged into one multi-draw call.
+auto mesh_key(GpuMesh const& mesh) -> std::uint32_t
+{
+    return (mesh.layout & 0xF) << 16 | (mesh.id & 0xFFFF);
+}
+
+auto shader_key(std::vector<Shader const*>& shaders, Shader const* shader) -> std::uint32_t
+{
+    auto it = std::find(shaders.cbegin(), shaders.cend(), shader);
+    if (it == shaders.cend()) {
+        shaders.push_back(shader);
+        return static_cast<std::uint32_t>(shaders.size() - 1);
+    }
+
+    return static_cast<std::uint32_t>(std::distance(shaders.cbegin(), it));
+}
+
+// Tracks the state bound during submission, so that it is only changed when a draw actually
+// requires different state.
+struct SubmissionState
+{
+    SubmissionState(Render::Stats& stats,
+                    GeometryPool const& geometry_pool,
+                    Shader const* shader_override) :
+        stats(stats), geometry_pool(geometry_pool), shader_override(shader_override)
+    {
+    }
+
+    Render::Stats& stats;
+    GeometryPool const& geometry_pool;
+
+    // Draws all items with this shader instead of the one of their material if set.
+    Shader const* shader_override;
+
+    Shader const* shader = nullptr;
+    std::optional<std::uint32_t> material;
+    std::optional<std::uint32_t> layout;
+
+    [[nodiscard]] auto shader_of(RenderItem const& item) const -> Shader const*
+    {
+        return shader_override != nullptr ? shader_override : item.material->shader.handle().get();
+    }
+
+    void bind(RenderItem const& item)
+    {
+        Shader const* item_shader = shader_of(item);
+        if (item_shader != shader) {
+            shader = item_shader;
+            shader->bind();
+            ++stats.program_binds;
+        }
+
+        if (item.material->id != material) {
+            material = item.material->id;
+            item.material->bind();
+            stats.texture_binds += item.material->texture_count();
+        }
+
+        if (item.mesh->layout != layout) {
+            layout = item.mesh->layout;
+            GlState::bind_vertex_array(geometry_pool.vertex_array(item.mesh->layout));
+            ++stats.vao_binds;
+        }
+    }
+
+    [[nodiscard]] auto compatible(RenderItem const& item) const -> bool
+    {
+        return shader_of(item) == shader && item.material->id == material &&
+               item.mesh->layout == layout;
+    }
+};
+
+void group_instances(std::span<RenderItem const> items,
+                     bool instancing,
+                     std::vector<InstanceGroup>& groups)
+{
+    groups.clear();
+
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        if (instancing && i > 0 && items[i].mesh->id == items[i - 1].mesh->id &&
+            items[i].material->id == items[i - 1].material->id) {
+            ++groups.back().count;
+            continue;
+        }
+
+        groups.push_back(InstanceGroup{.first = i, .count = 1});
+    }
+}
+
+void draw_direct(std::span<RenderItem const> items,
+                 std::span<InstanceGroup const> groups,
+                 SubmissionState& state)
+{
+    for (auto const& group : groups) {
+        auto const& item = items[group.first];
+        state.bind(item);
+
+        // The base instance selects the per-draw data of the first instance.
+        glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES,
+                                                      item.mesh->indices_count,
+                                                      item.mesh->indices_type,
+                                                      item.mesh->indices_offset(),
+                                                      static_cast<GLsizei>(group.count),
+                                                      item.mesh->base_vertex,
+                                                      static_cast<GLuint>(group.first));
+        ++state.stats.draw_calls;
+        state.stats.triangles +=
+            static_cast<std::uint64_t>(item.mesh->indices_count / 3) * group.count;
+    }
+}
+
+void draw_indirect(std::span<RenderItem const> items,
+                   std::span<InstanceGroup const> groups,
+                   RingBuffer& frame_data,
+                   SubmissionState& state)
+{
+    auto allocation = frame_data.allocate(
+        static_cast<GLsizeiptr>(groups.size() * sizeof(DrawElementsIndirectCommand)));
+    std::span commands(static_cast<DrawElementsIndirectCommand*>(allocation.data), groups.size());
+
+    for (std::size_t i = 0; i < groups.size(); ++i) {
+        auto const& group = groups[i];
+        auto const& mesh = *items[group.first].mesh;
+        commands[i] =
+            DrawElementsIndirectCommand{.count = static_cast<GLuint>(mesh.indices_count),
+                                        .instance_count = static_cast<GLuint>(group.count),
+                                        .first_index = mesh.first_index,
+                                        .base_vertex = mesh.base_vertex,
+                                        .base_instance = static_cast<GLuint>(group.first)};
+        state.stats.triangles += static_cast<std::uint64_t>(mesh.indices_count / 3) * group.count;
+    }
+
+    GlState::bind_buffer(GL_DRAW_INDIRECT_BUFFER, frame_data.buffer());
+
+    std::size_t batch_begin = 0;
+    while (batch_begin < groups.size()) {
+        auto const& item = items[groups[batch_begin].first];
+        state.bind(item);
+
+        auto batch_end = batch_begin + 1;
+        while (batch_end < groups.size() && state.compatible(items[groups[batch_end].first])) {
+            ++batch_end;
+        }
+
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast, performance-no-int-to-ptr)
+        auto const* commands_offset = reinterpret_cast<void const*>(
+            allocation.offset + batch_begin * sizeof(DrawElementsIndirectCommand));
+
+        glMultiDrawElementsIndirect(GL_TRIANGLES,
+                                    item.mesh->indices_type,
+                                    commands_offset,
+                                    static_cast<GLsizei>(batch_end - batch_begin),
+                                    0);
+        ++state.stats.draw_calls;
+
+        batch_begin = batch_end;
+    }
+}
+
+} // namespace
 
 void Render::render(entt::registry& registry)
 {
     auto mesh_view = registry.view<GpuMesh const, GpuMaterial const, GlobalTransform const>();
     auto camera_view = registry.view<Camera const, GlobalTransform const>();
     auto camera_entity = camera_view.front();
-    
+
+    auto& stats = registry.ctx().get<Stats>();
+    stats = {};
+
     if (camera_entity == entt::null) {
         spdlog::debug("No camera entity found");
         return;
     }
 
     auto [camera, camera_transform] = camera_view.get(camera_entity);
-    glm::mat4 view_projection_matrix =
-        camera.projection_matrix() * Camera::view_matrix(camera_transform);
+    glm::mat4 view_matrix = Camera::view_matrix(camera_transform);
+    glm::mat4 projection_matrix = camera.projection_matrix();
+    float far_plane = std::visit([](auto const& projection) { return projection.far; },
+                                 camera.projection);
+
+    auto& context = registry.ctx().emplace<RenderContext>();
+    auto const& settings = registry.ctx().get<Settings>();
+    bool const deferred = settings.shading == Shading::Deferred;
+
+    auto& geometry_pool = registry.ctx().get<GeometryPool>();
+    SubmissionState state(stats, geometry_pool, deferred ? &context.geometry_shader : nullptr);
+
+    context.queue.clear();
+    context.shaders.clear();
 
     for (auto [entity, mesh, material, transform] : mesh_view.each()) {
-        auto shader = material.shader;
-        shader->bind();
-
-        // Bind textures
-        material.bind();
-
-        // Bind modelview matrix uniform
-        {
-            glm::mat4 modelViewProj = view_projection_matrix * transform.transform;
-            shader->set_uniform("u_modelViewProjMatrix", modelViewProj);
-            shader->set_uniform("u_modelMatrix", transform.transform);
-            shader->set_uniform("u_viewPosition", camera_transform.position());
-        }
+        // Opaque geometry is drawn front to back to benefit from early depth testing.
+        float depth = -(view_matrix * transform.transform[3]).z / far_plane;
+
+        RenderItem item{.mesh = &mesh, .material = &material, .model_matrix = transform.transform};
+
+        auto shader = shader_key(context.shaders, state.shader_of(item));
+        auto key = RenderQueue::sort_key(
+            RenderQueue::Pass::Opaque, shader, material.id, mesh_key(mesh), depth);
+
+        context.queue.push(key, item);
+    }
 
-        glBindVertexArray(mesh.vao);
-        glDrawElements(GL_TRIANGLES, mesh.indices_count, mesh.indices_type, nullptr);
-        glBindVertexArray(0);
+    context.queue.sort();
+    auto items = context.queue.items();
 
-        Shader::unbind();
+    if (items.empty()) {
+        return;
     }
+
+    group_instances(items, settings.instancing, context.instance_groups);
+
+    // All data of the frame is written into one region of the ring buffer.
+    auto& frame_data = context.frame_data;
+    auto const draw_data_size = static_cast<GLsizeiptr>(items.size() * sizeof(DrawData));
+    auto const commands_size = settings.submission == Submission::Indirect
+                                   ? static_cast<GLsizeiptr>(context.instance_groups.size() *
+                                                             sizeof(DrawElementsIndirectCommand))
+                                   : 0;
+
+    frame_data.begin_frame(frame_data.aligned(sizeof(ViewData)) +
+                           frame_data.aligned(draw_data_size) + frame_data.aligned(commands_size));
+
+    auto view_allocation = frame_data.allocate(sizeof(ViewData));
+    *static_cast<ViewData*>(view_allocation.data) =
+        ViewData{.view_matrix = view_matrix,
+                 .projection_matrix = projection_matrix,
+                 .view_projection_matrix = projection_matrix * view_matrix,
+                 .inverse_view_matrix = glm::inverse(view_matrix),
+                 .inverse_projection_matrix = glm::inverse(projection_matrix),
+                 .view_position = glm::vec4(camera_transform.position(), 1.0F)};
+
+    // Per-draw data, indexed by the base instance of each draw and the instance index
+    auto draw_data_allocation = frame_data.allocate(draw_data_size);
+    std::span draw_data(static_cast<DrawData*>(draw_data_allocation.data), items.size());
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        draw_data[i] = DrawData{.model_matrix = items[i].model_matrix};
+    }
+
+    GlState::bind_buffer_range(GL_UNIFORM_BUFFER,
+                               RenderContext::VIEW_DATA_BINDING,
+                               frame_data.buffer(),
+                               view_allocation.offset,
+                               view_allocation.size);
+    GlState::bind_buffer_range(GL_SHADER_STORAGE_BUFFER,
+                               RenderContext::DRAW_DATA_BINDING,
+                               frame_data.buffer(),
+                               draw_data_allocation.offset,
+                               draw_data_allocation.size);
+
+    geometry_pool.reserve_draw_ids(items.size());
+
+    GLuint const target_frame_buffer = GlState::framebuffer();
+
+    if (deferred) {
+        context.g_buffer.bind(registry.ctx().get<TexturePool>(),
+                              registry.ctx().get<Viewport>().dimensions);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    switch (settings.submission) {
+    case Submission::Direct:
+        draw_direct(items, context.instance_groups, state);
+        break;
+    case Submission::Indirect:
+        draw_indirect(items, context.instance_groups, frame_data, state);
+        break;
+    }
+
+    if (deferred) {
+        GpuProfiler::Scope scope(registry.ctx().get<GpuProfiler>(), "deferred_lighting");
+        context.g_buffer.resolve(
+            registry.ctx().get<TexturePool>(), context.lighting_shader, target_frame_buffer);
+    }
+
+    frame_data.end_frame();
 }
@@ -1,9 +1,53 @@
 #pragma once
 
+#include <cstdint>
 #include <entt/entt.hpp>
+#include <glm/glm.hpp>
 
 namespace Render {
 
+enum class Submission
+{
+    // One draw call per entity.
+    Direct,
+    // One multi-draw indirect call per batch of draws sharing shader, material and vertex layout.
+    Indirect,
+};
+
+enum class Shading
+{
+    // Lighting is computed while drawing the geometry.
+    Forward,
+    // Geometry is drawn into a G-buffer, which is lit once per pixel afterwards.
+    Deferred,
+};
+
+struct Settings
+{
+    Submission submission = Submission::Indirect;
+    Shading shading = Shading::Forward;
+
+    // Draw entities sharing mesh and material as instances of one draw.
+    bool instancing = true;
+};
+
+// Size of the targets the scene is rendered into. It follows the size of the window scaled by
+// dynamic resolution, but lags behind while the window is being resized.
+struct Viewport
+{
+    glm::u32vec2 dimensions;
+};
+
+// GL state changes and draw calls issued by the last call to render().
+struct Stats
+{
+    unsigned draw_calls{};
+    unsigned program_binds{};
+    unsigned texture_binds{};
+    unsigned vao_binds{};
+    std::uint64_t triangles{};
+};
+
 void render(entt::registry& registry);
 
 } // namespace Render
@@ -0,0 +1,172 @@
+#include "render_graph.h"
+#include "core/graphics/gl_state.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr auto UNUSED = std::numeric_limits<std::uint32_t>::max();
+
+} // namespace
+
+auto RenderGraph::PassBuilder::create(TextureDescription const& description) -> TextureHandle
+{
+    graph.resources.push_back(Resource{.description = description});
+
+    auto version = static_cast<std::uint32_t>(graph.versions.size());
+    graph.versions.push_back(
+        Version{.resource = static_cast<std::uint32_t>(graph.resources.size() - 1),
+                .writer = pass});
+    graph.passes.at(pass).writes.push_back(version);
+
+    return {version};
+}
+
+void RenderGraph::PassBuilder::read(TextureHandle texture)
+{
+    auto& builder_pass = graph.passes.at(pass);
+    builder_pass.reads.push_back(texture.version);
+    builder_pass.dependencies.push_back(texture.version);
+}
+
+auto RenderGraph::PassBuilder::write(TextureHandle texture) -> TextureHandle
+{
+    auto version = static_cast<std::uint32_t>(graph.versions.size());
+    graph.versions.push_back(
+        Version{.resource = graph.versions.at(texture.version).resource, .writer = pass});
+
+    auto& builder_pass = graph.passes.at(pass);
+    builder_pass.writes.push_back(version);
+    builder_pass.dependencies.push_back(texture.version);
+
+    return {version};
+}
+
+void RenderGraph::PassBuilder::side_effect()
+{
+    graph.passes.at(pass).side_effect = true;
+}
+
+auto RenderGraph::PassContext::texture(TextureHandle handle) const -> GLuint
+{
+    return graph.resources.at(graph.versions.at(handle.version).resource).texture;
+}
+
+void RenderGraph::PassContext::draw_fullscreen_triangle() const
+{
+    GlState::bind_vertex_array(graph.empty_vertex_array);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+RenderGraph::RenderGraph()
+{
+    glGenVertexArrays(1, &empty_vertex_array);
+}
+
+RenderGraph::~RenderGraph()
+{
+    GlState::delete_vertex_array(empty_vertex_array);
+}
+
+void RenderGraph::add_pass(std::string name, Setup const& setup, Execute execute)
+{
+    passes.push_back(Pass{.name = std::move(name), .execute = std::move(execute)});
+
+    PassBuilder builder(*this, static_cast<std::uint32_t>(passes.size() - 1));
+    setup(builder);
+}
+
+void RenderGraph::execute(TexturePool& pool, GpuProfiler& profiler)
+{
+    // Writers always precede their readers, so walking the passes backwards visits every pass
+    // after all passes depending on it.
+    std::vector<bool> alive(passes.size());
+    for (std::size_t i = passes.size(); i-- > 0;) {
+        if (!alive[i] && !passes[i].side_effect) {
+            continue;
+        }
+
+        alive[i] = true;
+        for (auto version : passes[i].dependencies) {
+            alive[versions.at(version).writer] = true;
+        }
+    }
+
+    culled_pass_count = static_cast<unsigned>(std::count(alive.cbegin(), alive.cend(), false));
+
+    // Lifetime of every resource as the first and last pass using it.
+    std::vector<std::uint32_t> first_use(resources.size(), UNUSED);
+    std::vector<std::uint32_t> last_use(resources.size(), UNUSED);
+
+    auto for_each_resource = [this](Pass const& pass, auto&& function) {
+        for (auto const* pass_versions : {&pass.reads, &pass.writes}) {
+            for (auto version : *pass_versions) {
+                function(versions.at(version).resource);
+            }
+        }
+    };
+
+    for (std::uint32_t i = 0; i < passes.size(); ++i) {
+        if (!alive[i]) {
+            continue;
+        }
+
+        for_each_resource(passes[i], [&](std::uint32_t resource) {
+            if (first_use[resource] == UNUSED) {
+                first_use[resource] = i;
+            }
+            last_use[resource] = i;
+        });
+    }
+
+    std::vector<GLuint> attachments;
+
+    for (std::uint32_t i = 0; i < passes.size(); ++i) {
+        if (!alive[i]) {
+            continue;
+        }
+
+        auto const& pass = passes[i];
+        GpuProfiler::Scope scope(profiler, pass.name);
+
+        for_each_resource(pass, [&](std::uint32_t resource) {
+            if (first_use[resource] == i && resources[resource].texture == 0) {
+                resources[resource].texture = pool.acquire(resources[resource].description);
+            }
+        });
+
+        if (!pass.writes.empty()) {
+            attachments.clear();
+            for (auto version : pass.writes) {
+                attachments.push_back(resources[versions.at(version).resource].texture);
+            }
+
+            pool.bind_framebuffer(attachments);
+
+            auto const& target = resources[versions.at(pass.writes.front()).resource];
+            glViewport(0,
+                       0,
+                       static_cast<GLsizei>(target.description.dimensions.x),
+                       static_cast<GLsizei>(target.description.dimensions.y));
+        }
+
+        pass.execute(PassContext(*this));
+
+        for_each_resource(pass, [&](std::uint32_t resource) {
+            if (last_use[resource] == i && resources[resource].texture != 0) {
+                pool.release(resources[resource].texture);
+                resources[resource].texture = 0;
+            }
+        });
+    }
+
+    clear();
+}
+
+void RenderGraph::clear()
+{
+    resources.clear();
+    versions.clear();
+    passes.clear();
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "core/graphics/gpu_profiler.h"
+#include "core/graphics/texture_pool.h"
+
+#include <cstdint>
+#include <functional>
+#include <glad/gl.h>
+#include <string>
+#include <vector>
+
+// Describes a frame as passes reading and writing transient textures. Passes that contribute
+// to no pass with side effects are culled. Transient textures are taken from a TexturePool just
+// before their first use and returned right after their last one, so that textures with
+// disjoint lifetimes in the frame share the same memory.
+class RenderGraph
+{
+public:
+    // One version of a texture. Writing a texture creates a new version, so that every version
+    // has exactly one writer, which passes reading it depend on.
+    struct TextureHandle
+    {
+        std::uint32_t version;
+    };
+
+    class PassBuilder
+    {
+    public:
+        // Creates a texture written by this pass. Its content is undefined until the pass
+        // clears or draws into it, as its memory is shared with other textures.
+        auto create(TextureDescription const& description) -> TextureHandle;
+
+        void read(TextureHandle texture);
+
+        // Continues to draw into a texture written by an earlier pass.
+        auto write(TextureHandle texture) -> TextureHandle;
+
+        // Marks a pass with effects outside of the graph, e.g. drawing into the window, which
+        // is never culled.
+        void side_effect();
+
+    private:
+        friend class RenderGraph;
+
+        PassBuilder(RenderGraph& graph, std::uint32_t pass) : graph(graph), pass(pass) {}
+
+        RenderGraph& graph;
+        std::uint32_t pass;
+    };
+
+    class PassContext
+    {
+    public:
+        [[nodiscard]] auto texture(TextureHandle handle) const -> GLuint;
+
+        // Draws a triangle covering the viewport, for passes that shade every pixel.
+        void draw_fullscreen_triangle() const;
+
+    private:
+        friend class RenderGraph;
+
+        PassContext(RenderGraph const& graph) : graph(graph) {}
+
+        RenderGraph const& graph;
+    };
+
+    using Setup = std::function<void(PassBuilder&)>;
+    using Execute = std::function<void(PassContext const&)>;
+
+    RenderGraph();
+    ~RenderGraph();
+
+    RenderGraph(RenderGraph const&) = delete;
+    auto operator=(RenderGraph const&) -> RenderGraph& = delete;
+    RenderGraph(RenderGraph&&) = delete;
+    auto operator=(RenderGraph&&) -> RenderGraph& = delete;
+
+    // Runs the setup immediately, so the handles it creates can be used by later passes. A pass
+    // can only read what earlier passes wrote, so passes execute in the order they are added.
+    // Passes writing textures execute with their framebuffer bound and the viewport set.
+    void add_pass(std::string name, Setup const& setup, Execute execute);
+
+    // Culls and executes the passes added since the last call and clears the graph. Every
+    // executed pass is a profiler scope named after it.
+    void execute(TexturePool& pool, GpuProfiler& profiler);
+
+    [[nodiscard]] auto culled_passes() const -> unsigned { return culled_pass_count; }
+
+private:
+    struct Resource
+    {
+        TextureDescription description;
+        GLuint texture{};
+    };
+
+    struct Version
+    {
+        std::uint32_t resource;
+        std::uint32_t writer;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        Execute execute;
+
+        std::vector<std::uint32_t> reads{};
+        std::vector<std::uint32_t> writes{};
+
+        // Versions the pass depends on, the read ones and the previous versions of the
+        // written ones.
+        std::vector<std::uint32_t> dependencies{};
+
+        bool side_effect{};
+    };
+
+    void clear();
+
+    std::vector<Resource> resources;
+    std::vector<Version> versions;
+    std::vector<Pass> passes;
+
+    unsigned culled_pass_count{};
+
+    // A VAO is necessary although no data is stored in it
+    GLuint empty_vertex_array{};
+};
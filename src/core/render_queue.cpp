@@ -0,0 +1,81 @@
+#include "render_queue.h"
+
+#include <algorithm>
+#include <array>
+
+auto RenderQueue::sort_key(Pass pass,
+                           std::uint32_t shader,
+                           std::uint32_t material,
+                           std::uint32_t mesh,
+                           float depth) -> std::uint64_t
+{
+    static constexpr std::uint64_t DEPTH_MAX = 0xFFFF;
+
+    auto const quantized_depth =
+        static_cast<std::uint64_t>(std::clamp(depth, 0.0F, 1.0F) * static_cast<float>(DEPTH_MAX));
+
+    return (static_cast<std::uint64_t>(pass) & 0xF) << 60 |
+           (static_cast<std::uint64_t>(shader) & 0xFF) << 52 |
+           (static_cast<std::uint64_t>(material) & 0xFFFF) << 36 |
+           (static_cast<std::uint64_t>(mesh) & 0xFFFFF) << 16 | quantized_depth;
+}
+
+void RenderQueue::clear()
+{
+    entries.clear();
+    unsorted_items.clear();
+    sorted_items.clear();
+}
+
+void RenderQueue::push(std::uint64_t key, RenderItem const& item)
+{
+    entries.push_back(Entry{.key = key, .item = static_cast<std::uint32_t>(unsorted_items.size())});
+    unsorted_items.push_back(item);
+}
+
+void RenderQueue::sort()
+{
+    if (entries.empty()) {
+        return;
+    }
+
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-constant-array-index)
+    // Build the histograms of all digits in one sweep.
+    std::array<std::array<std::uint32_t, RADIX_SIZE>, RADIX_PASSES> histograms{};
+    for (auto const& entry : entries) {
+        for (unsigned pass = 0; pass < RADIX_PASSES; ++pass) {
+            ++histograms[pass][(entry.key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)];
+        }
+    }
+
+    scratch.resize(entries.size());
+
+    for (unsigned pass = 0; pass < RADIX_PASSES; ++pass) {
+        unsigned const shift = pass * RADIX_BITS;
+        auto const& histogram = histograms.at(pass);
+
+        // All keys share this digit, the pass would not change the order.
+        if (histogram.at((entries.front().key >> shift) & (RADIX_SIZE - 1)) == entries.size()) {
+            continue;
+        }
+
+        std::array<std::uint32_t, RADIX_SIZE> offsets{};
+        std::uint32_t offset = 0;
+        for (std::size_t digit = 0; digit < RADIX_SIZE; ++digit) {
+            offsets.at(digit) = offset;
+            offset += histogram.at(digit);
+        }
+
+        for (auto const& entry : entries) {
+            scratch[offsets[(entry.key >> shift) & (RADIX_SIZE - 1)]++] = entry;
+        }
+
+        std::swap(entries, scratch);
+    }
+    // NOLINTEND(cppcoreguidelines-pro-bounds-constant-array-index)
+
+    sorted_items.reserve(entries.size());
+    for (auto const& entry : entries) {
+        sorted_items.push_back(unsorted_items[entry.item]);
+    }
+}
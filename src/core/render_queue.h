@@ -0,0 +1,60 @@
+#pragma once
+
+#include "core/graphics/material.h"
+#include "core/graphics/mesh.h"
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+struct RenderItem
+{
+    GpuMesh const *mesh;
+    GpuMaterial const *material;
+    glm::mat4 model_matrix;
+};
+
+// Collects the draws of a frame and orders them by a 64 bit sort key, so that consecutive
+// draws share as much GL state as possible.
+class RenderQueue
+{
+public:
+    enum class Pass : std::uint8_t
+    {
+        Opaque,
+    };
+
+    // Bit layout from most to least significant:
+    // pass (4) | shader (8) | material (16) | mesh (20) | depth (16)
+    // Ids wider than their field are truncated, which only affects the quality of the order.
+    static auto sort_key(Pass pass,
+                         std::uint32_t shader,
+                         std::uint32_t material,
+                         std::uint32_t mesh,
+                         float depth) -> std::uint64_t;
+
+    void clear();
+    void push(std::uint64_t key, RenderItem const &item);
+
+    // Radix sorts the pushed items by their key.
+    void sort();
+
+    [[nodiscard]] auto items() const -> std::span<RenderItem const> { return sorted_items; }
+
+private:
+    static constexpr unsigned RADIX_BITS = 8;
+    static constexpr std::size_t RADIX_SIZE = 1U << RADIX_BITS;
+    static constexpr unsigned RADIX_PASSES = 64 / RADIX_BITS;
+
+    struct Entry
+    {
+        std::uint64_t key;
+        std::uint32_t item;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<Entry> scratch;
+    std::vector<RenderItem> unsorted_items;
+    std::vector<RenderItem> sorted_items;
+};
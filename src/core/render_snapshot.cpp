@@ -0,0 +1,151 @@
+#include "render_snapshot.h"
+
+#include <bit>
+#include <type_traits>
+
+namespace {
+
+auto hash_combine(std::uint64_t seed, std::uint64_t value) -> std::uint64_t
+{
+    return seed ^ (value + 0x9E3779B97F4A7C15 + (seed << 6) + (seed >> 2));
+}
+
+template <glm::length_t L> auto hash_floats(std::uint64_t hash, glm::vec<L, float> const& vector)
+    -> std::uint64_t
+{
+    for (glm::length_t i = 0; i < L; ++i) {
+        hash = hash_combine(hash, std::bit_cast<std::uint32_t>(vector[i]));
+    }
+    return hash;
+}
+
+auto hash_floats(std::uint64_t hash, glm::mat4 const& matrix) -> std::uint64_t
+{
+    for (glm::length_t column = 0; column < 4; ++column) {
+        hash = hash_floats(hash, matrix[column]);
+    }
+    return hash;
+}
+
+// Entities of a pool and the properties of their components the rendered image depends on
+template <typename Component, typename Properties>
+auto hash_pool(std::uint64_t hash,
+               RenderSnapshot::Pool<Component> const& pool,
+               Properties const& properties) -> std::uint64_t
+{
+    hash = hash_combine(hash, pool.entities.size());
+    for (auto entity : pool.entities) {
+        hash = hash_combine(hash, entt::to_integral(entity));
+    }
+    for (auto const& component : pool.components) {
+        hash = properties(hash, component);
+    }
+    return hash;
+}
+
+template <typename Component>
+void extract_pool(entt::registry const& registry, RenderSnapshot::Pool<Component>& pool)
+{
+    pool.entities.clear();
+    pool.components.clear();
+
+    auto view = registry.view<Component const, GlobalTransform const>();
+    for (auto entity : view) {
+        pool.entities.push_back(entity);
+        if constexpr (!std::is_empty_v<Component>) {
+            pool.components.push_back(view.template get<Component const>(entity));
+        }
+    }
+}
+
+template <typename Component>
+void insert_pool(entt::registry& registry, RenderSnapshot::Pool<Component> const& pool)
+{
+    if constexpr (std::is_empty_v<Component>) {
+        registry.insert<Component>(pool.entities.begin(), pool.entities.end());
+    } else {
+        registry.insert<Component>(
+            pool.entities.begin(), pool.entities.end(), pool.components.begin());
+    }
+}
+
+} // namespace
+
+void RenderSnapshot::extract(entt::registry const& registry, float alpha)
+{
+    transforms.entities.clear();
+    transforms.components.clear();
+
+    for (auto [entity, transform] : registry.view<GlobalTransform const>().each()) {
+        if (!registry.any_of<GpuMesh, Camera, DirectionalLight, PointLight>(entity)) {
+            continue;
+        }
+
+        transforms.entities.push_back(entity);
+        if (auto const* previous = registry.try_get<PreviousGlobalTransform>(entity)) {
+            GlobalTransform previous_transform;
+            previous_transform.transform = previous->transform;
+            transforms.components.push_back(
+                GlobalTransform::interpolate(previous_transform, transform, alpha));
+        } else {
+            transforms.components.push_back(transform);
+        }
+    }
+
+    extract_pool(registry, meshes);
+    extract_pool(registry, materials);
+    extract_pool(registry, cameras);
+    extract_pool(registry, directional_lights);
+    extract_pool(registry, point_lights);
+    extract_pool(registry, dynamic_shadow_casters);
+}
+
+auto RenderSnapshot::fingerprint() const -> std::uint64_t
+{
+    std::uint64_t hash = hash_combine(window_dimensions.x, window_dimensions.y);
+    hash = hash_combine(hash, target_dimensions.x);
+    hash = hash_combine(hash, target_dimensions.y);
+
+    hash = hash_pool(hash, transforms, [](std::uint64_t seed, GlobalTransform const& transform) {
+        return hash_floats(seed, transform.transform);
+    });
+    hash = hash_pool(hash, meshes, [](std::uint64_t seed, GpuMesh const& mesh) {
+        return hash_combine(seed, mesh.id);
+    });
+    hash = hash_pool(hash, materials, [](std::uint64_t seed, GpuMaterial const& material) {
+        return hash_combine(seed, material.id);
+    });
+    hash = hash_pool(hash, cameras, [](std::uint64_t seed, Camera const& camera) {
+        return hash_floats(seed, camera.projection_matrix());
+    });
+    hash = hash_pool(
+        hash, directional_lights, [](std::uint64_t seed, DirectionalLight const& light) {
+            return hash_combine(hash_floats(seed, light.color.to_vec3()),
+                                std::bit_cast<std::uint32_t>(light.illuminance));
+        });
+    hash = hash_pool(hash, point_lights, [](std::uint64_t seed, PointLight const& light) {
+        return hash_combine(hash_floats(seed, light.color.to_vec3()),
+                            std::bit_cast<std::uint32_t>(light.intensity));
+    });
+    hash = hash_pool(hash, dynamic_shadow_casters, [](std::uint64_t seed, DynamicShadowCaster) {
+        return seed;
+    });
+
+    return hash;
+}
+
+void RenderSnapshot::apply(entt::registry& render_registry) const
+{
+    render_registry.clear();
+    for (auto entity : transforms.entities) {
+        render_registry.create(entity);
+    }
+
+    insert_pool(render_registry, transforms);
+    insert_pool(render_registry, meshes);
+    insert_pool(render_registry, materials);
+    insert_pool(render_registry, cameras);
+    insert_pool(render_registry, directional_lights);
+    insert_pool(render_registry, point_lights);
+    insert_pool(render_registry, dynamic_shadow_casters);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "components/transform.h"
+#include "core/camera.h"
+#include "core/graphics/material.h"
+#include "core/graphics/mesh.h"
+#include "core/light.h"
+#include "core/shadows.h"
+
+#include <chrono>
+#include <cstdint>
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+#include <vector>
+
+// The render data of one frame, copied out of the registry so that it can be drawn while the
+// registry already simulates the next frame. Only entities with a GlobalTransform and a mesh,
+// camera or light are copied.
+struct RenderSnapshot
+{
+    template <typename Component> struct Pool
+    {
+        std::vector<entt::entity> entities;
+        std::vector<Component> components; // Empty for tag components
+    };
+
+    std::uint64_t frame{};
+
+    // Time the main thread spent on the frame until the snapshot was taken
+    std::chrono::duration<float, std::milli> simulation_time{};
+
+    glm::u32vec2 window_dimensions{};
+    glm::u32vec2 target_dimensions{};
+    bool capture = false;
+
+    Pool<GlobalTransform> transforms;
+    Pool<GpuMesh> meshes;
+    Pool<GpuMaterial> materials;
+    Pool<Camera> cameras;
+    Pool<DirectionalLight> directional_lights;
+    Pool<PointLight> point_lights;
+    Pool<DynamicShadowCaster> dynamic_shadow_casters;
+
+    // Interpolated entities are placed alpha of the way from their previous to their current
+    // transform. Reuses the memory of the previous extraction.
+    void extract(entt::registry const& registry, float alpha);
+
+    // Hash of everything that affects the rendered image, equal for snapshots drawn the same.
+    [[nodiscard]] auto fingerprint() const -> std::uint64_t;
+
+    // Replaces all entities of the render registry with the ones of the snapshot. Entities keep
+    // their identifiers, so caches keyed by entity stay valid between frames.
+    void apply(entt::registry& render_registry) const;
+};
@@ -0,0 +1,75 @@
+#include "render_thread.h"
+
+#include "util/profiler.h"
+
+#include <GLFW/glfw3.h>
+
+RenderThread::RenderThread(GLFWwindow& window, Render render) :
+    window(window), render(std::move(render))
+{
+    // A context can only be current on one thread at a time.
+    glfwMakeContextCurrent(nullptr);
+    thread = std::thread(&RenderThread::run, this);
+}
+
+RenderThread::~RenderThread()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+
+    thread.join();
+    glfwMakeContextCurrent(&window);
+}
+
+auto RenderThread::acquire() -> RenderSnapshot&
+{
+    std::unique_lock lock(mutex);
+    condition.wait(lock, [this] { return pending != write_index && rendering != write_index; });
+    return snapshots.at(write_index);
+}
+
+void RenderThread::submit()
+{
+    {
+        std::unique_lock lock(mutex);
+        condition.wait(lock, [this] { return !pending.has_value(); });
+        pending = write_index;
+        write_index = 1 - write_index;
+    }
+    condition.notify_all();
+}
+
+void RenderThread::run()
+{
+    FEVER_PROFILE_THREAD("render");
+    glfwMakeContextCurrent(&window);
+
+    while (true) {
+        std::size_t index{};
+        {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this] { return pending.has_value() || stopping; });
+            if (!pending.has_value()) {
+                break;
+            }
+
+            index = pending.value();
+            pending.reset();
+            rendering = index;
+        }
+        condition.notify_all();
+
+        render(snapshots.at(index));
+
+        {
+            std::lock_guard lock(mutex);
+            rendering.reset();
+        }
+        condition.notify_all();
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "core/render_snapshot.h"
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+struct GLFWwindow;
+
+// Renders snapshots on a thread owning the GL context while the calling thread simulates the next
+// frame. The snapshots are double-buffered, the calling thread fills one while the other is
+// rendered. It runs at most one frame ahead and waits for the render thread otherwise.
+class RenderThread
+{
+public:
+    using Render = std::function<void(RenderSnapshot const&)>;
+
+    // Takes over the GL context of the window, which has to be current on the calling thread.
+    RenderThread(GLFWwindow& window, Render render);
+
+    // Renders the submitted snapshot and makes the context current on the calling thread again.
+    ~RenderThread();
+
+    RenderThread(RenderThread const&) = delete;
+    auto operator=(RenderThread const&) -> RenderThread& = delete;
+    RenderThread(RenderThread&&) = delete;
+    auto operator=(RenderThread&&) -> RenderThread& = delete;
+
+    // Waits until the render thread is done with the snapshot to fill next.
+    auto acquire() -> RenderSnapshot&;
+
+    // Hands the acquired snapshot over to the render thread.
+    void submit();
+
+private:
+    void run();
+
+    GLFWwindow& window;
+    Render render;
+
+    std::array<RenderSnapshot, 2> snapshots;
+    std::size_t write_index = 0;
+    std::optional<std::size_t> pending;
+    std::optional<std::size_t> rendering;
+    bool stopping = false;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    std::thread thread;
+};
@@ -0,0 +1,170 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <fstream>
+#include <spdlog/spdlog.h>
+
+namespace Replay {
+
+namespace {
+
+constexpr std::array<char, 4> MAGIC{'F', 'F', 'R', 'P'};
+constexpr std::uint32_t VERSION = 1;
+
+class Writer
+{
+public:
+    explicit Writer(std::ofstream& file) : file(file) {}
+
+    template <typename T> void write(T value)
+    {
+        auto bits = std::bit_cast<std::array<std::uint8_t, sizeof(T)>>(value);
+        if constexpr (std::endian::native == std::endian::big) {
+            std::reverse(bits.begin(), bits.end());
+        }
+        file.write(reinterpret_cast<char const*>(bits.data()), bits.size());
+    }
+
+private:
+    std::ofstream& file;
+};
+
+class Reader
+{
+public:
+    explicit Reader(std::ifstream& file) : file(file) {}
+
+    template <typename T> auto read() -> T
+    {
+        std::array<std::uint8_t, sizeof(T)> bits{};
+        file.read(reinterpret_cast<char*>(bits.data()), bits.size());
+        if constexpr (std::endian::native == std::endian::big) {
+            std::reverse(bits.begin(), bits.end());
+        }
+        return std::bit_cast<T>(bits);
+    }
+
+    [[nodiscard]] auto good() const -> bool { return file.good(); }
+
+private:
+    std::ifstream& file;
+};
+
+} // namespace
+
+auto save(std::filesystem::path const& path, Recording const& recording) -> bool
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        spdlog::error(R"(Could not write recording "{}")", path.string());
+        return false;
+    }
+
+    file.write(MAGIC.data(), MAGIC.size());
+
+    Writer writer(file);
+    writer.write(VERSION);
+    writer.write(static_cast<std::uint32_t>(recording.frames.size()));
+
+    for (auto const& frame : recording.frames) {
+        writer.write(frame.delta.count());
+        writer.write(frame.mouse_delta.x);
+        writer.write(frame.mouse_delta.y);
+
+        writer.write(static_cast<std::uint16_t>(frame.key_inputs.size()));
+        for (auto const& key_input : frame.key_inputs) {
+            writer.write(static_cast<std::int16_t>(key_input.key_code));
+            writer.write(static_cast<std::uint8_t>(key_input.action));
+        }
+    }
+
+    spdlog::info(R"(Saved {} frames to "{}")", recording.frames.size(), path.string());
+    return static_cast<bool>(file);
+}
+
+auto load(std::filesystem::path const& path) -> std::optional<Recording>
+{
+    std::ifstream file(path, std::ios::binary);
+
+    std::array<char, 4> magic{};
+    file.read(magic.data(), magic.size());
+
+    Reader reader(file);
+    if (!file || magic != MAGIC || reader.read<std::uint32_t>() != VERSION) {
+        spdlog::error(R"(Could not read recording "{}")", path.string());
+        return {};
+    }
+
+    // Every frame takes at least its delta, mouse motion and key count, which bounds the frame
+    // count of an intact file by its size.
+    constexpr std::uintmax_t MIN_FRAME_SIZE =
+        sizeof(double) + 2 * sizeof(float) + sizeof(std::uint16_t);
+
+    auto const frame_count = reader.read<std::uint32_t>();
+
+    std::error_code error;
+    auto const file_size = std::filesystem::file_size(path, error);
+    auto const position = static_cast<std::uintmax_t>(file.tellg());
+    if (!reader.good() || error || file_size < position ||
+        frame_count > (file_size - position) / MIN_FRAME_SIZE) {
+        spdlog::error(R"(Recording "{}" is truncated)", path.string());
+        return {};
+    }
+
+    Recording recording;
+    recording.frames.resize(frame_count);
+
+    for (auto& frame : recording.frames) {
+        frame.delta = std::chrono::duration<double>(reader.read<double>());
+        frame.mouse_delta.x = reader.read<float>();
+        frame.mouse_delta.y = reader.read<float>();
+
+        frame.key_inputs.resize(reader.read<std::uint16_t>());
+        for (auto& key_input : frame.key_inputs) {
+            key_input.key_code = static_cast<Input::KeyCode>(reader.read<std::int16_t>());
+            key_input.action = static_cast<Input::Action>(reader.read<std::uint8_t>());
+        }
+    }
+
+    if (!reader.good()) {
+        spdlog::error(R"(Recording "{}" is truncated)", path.string());
+        return {};
+    }
+
+    return recording;
+}
+
+Recorder::Recorder(entt::dispatcher& dispatcher) : dispatcher(dispatcher)
+{
+    dispatcher.sink<Input::KeyInput>().connect<&Recorder::key_event>(this);
+    dispatcher.sink<Input::MouseMotion>().connect<&Recorder::mouse_event>(this);
+}
+
+Recorder::~Recorder()
+{
+    dispatcher.sink<Input::KeyInput>().disconnect(this);
+    dispatcher.sink<Input::MouseMotion>().disconnect(this);
+}
+
+void Recorder::end_frame(std::chrono::duration<double> delta)
+{
+    current.delta = delta;
+    frames.frames.push_back(std::move(current));
+    current = {};
+}
+
+void Recorder::key_event(Input::KeyInput const& key_input)
+{
+    current.key_inputs.push_back(key_input);
+}
+
+void Recorder::mouse_event(Input::MouseMotion const& mouse_motion)
+{
+    // Summed like the cursor listener does, which yields the same motion when replayed as one
+    current.mouse_delta += mouse_motion.delta;
+}
+
+} // namespace Replay
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "input/input.h"
+
+#include <chrono>
+#include <entt/entt.hpp>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <optional>
+#include <vector>
+
+// Recordings of the input of a session, which replay the same frames deterministically.
+namespace Replay {
+
+struct Frame
+{
+    std::chrono::duration<double> delta;
+    std::vector<Input::KeyInput> key_inputs;
+
+    // Sum of the mouse motion events, in the order they were dispatched
+    glm::vec2 mouse_delta{};
+};
+
+struct Recording
+{
+    std::vector<Frame> frames;
+};
+
+// Stored as a little-endian binary file.
+auto save(std::filesystem::path const& path, Recording const& recording) -> bool;
+auto load(std::filesystem::path const& path) -> std::optional<Recording>;
+
+// Records the input events dispatched by a dispatcher.
+class Recorder
+{
+public:
+    explicit Recorder(entt::dispatcher& dispatcher);
+    ~Recorder();
+
+    Recorder(Recorder const&) = delete;
+    auto operator=(Recorder const&) -> Recorder& = delete;
+    Recorder(Recorder&&) = delete;
+    auto operator=(Recorder&&) -> Recorder& = delete;
+
+    // Closes the frame with the events dispatched since the last call.
+    void end_frame(std::chrono::duration<double> delta);
+
+    [[nodiscard]] auto recording() const -> Recording const& { return frames; }
+
+private:
+    void key_event(Input::KeyInput const& key_input);
+    void mouse_event(Input::MouseMotion const& mouse_motion);
+
+    entt::dispatcher& dispatcher;
+
+    Recording frames;
+    Frame current{};
+};
+
+} // namespace Replay
@@ -0,0 +1,215 @@
+#include "scheduler.h"
+
+#include "core/jobs.h"
+#include "util/profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <spdlog/spdlog.h>
+#include <unordered_map>
+
+namespace {
+
+constexpr std::array<char const*, Scheduler::STAGE_COUNT> STAGE_NAMES{
+    "pre_update", "fixed_update", "fixed_post_update", "update", "post_update"};
+
+template <typename T> auto intersects(std::vector<T> const& lhs, std::vector<T> const& rhs) -> bool
+{
+    return std::ranges::any_of(lhs, [&rhs](T const& element) {
+        return std::ranges::find(rhs, element) != rhs.end();
+    });
+}
+
+auto storage_sizes(entt::registry& registry) -> std::unordered_map<entt::id_type, std::size_t>
+{
+    std::unordered_map<entt::id_type, std::size_t> sizes;
+    for (auto [id, storage] : registry.storage()) {
+        sizes.emplace(id, storage.size());
+    }
+    return sizes;
+}
+
+} // namespace
+
+auto Scheduler::Access::conflicts(Access const& other) const -> bool
+{
+    return exclusive_access || other.exclusive_access || intersects(writes, other.writes) ||
+           intersects(writes, other.reads) || intersects(reads, other.writes);
+}
+
+auto Scheduler::Access::writes_component(entt::id_type id) const -> bool
+{
+    return exclusive_access || std::ranges::find(writes, Resource{.id = id, .context = false}) !=
+                                   writes.end();
+}
+
+void Scheduler::add(Stage stage, std::string name, Access access, System system)
+{
+    add(stage,
+        std::move(name),
+        std::move(access),
+        [system = std::move(system)](entt::registry& registry, CommandBuffer&) {
+            system(registry);
+        });
+}
+
+void Scheduler::add(Stage stage, std::string name, Access access, DeferredSystem system)
+{
+    auto& entries = stages.at(static_cast<std::size_t>(stage));
+
+    Entry entry{.name = names.emplace_back(std::move(name)).c_str(),
+                .access = std::move(access),
+                .system = std::move(system)};
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (entry.access.conflicts(entries[i].access)) {
+            entry.dependencies.push_back(i);
+        }
+    }
+
+    spdlog::debug("System {} in stage {} waits for {} of {} systems",
+                  entry.name,
+                  STAGE_NAMES.at(static_cast<std::size_t>(stage)),
+                  entry.dependencies.size(),
+                  entries.size());
+
+    entries.push_back(std::move(entry));
+    prepared = false;
+}
+
+void Scheduler::run(entt::registry& registry, unsigned fixed_steps)
+{
+    if (!prepared) {
+        prepare(registry);
+    }
+
+    run_stage(registry, Stage::PreUpdate);
+
+    for (unsigned step = 0; step < fixed_steps; ++step) {
+        run_stage(registry, Stage::FixedUpdate);
+        run_stage(registry, Stage::FixedPostUpdate);
+    }
+
+    run_stage(registry, Stage::Update);
+    run_stage(registry, Stage::PostUpdate);
+}
+
+void Scheduler::run_stage(entt::registry& registry, Stage stage)
+{
+    auto& entries = stages.at(static_cast<std::size_t>(stage));
+
+    if (validation) {
+        run_validated(registry, entries);
+    } else {
+        run_parallel(registry, entries);
+    }
+
+    apply_commands(registry, entries);
+}
+
+void Scheduler::prepare(entt::registry& registry)
+{
+    for (auto const& entries : stages) {
+        for (auto const& entry : entries) {
+            for (auto* create_storage : entry.access.storages) {
+                create_storage(registry);
+            }
+        }
+    }
+
+    prepared = true;
+}
+
+void Scheduler::run_entry(entt::registry& registry, Entry& entry)
+{
+    FEVER_PROFILE_ZONE(entry.name);
+    auto const start = std::chrono::steady_clock::now();
+
+    entry.system(registry, entry.commands);
+
+    std::chrono::duration<float, std::milli> duration = std::chrono::steady_clock::now() - start;
+    entry.milliseconds = duration.count();
+    entry.total_milliseconds += duration.count();
+    ++entry.runs;
+}
+
+void Scheduler::run_parallel(entt::registry& registry, std::vector<Entry>& entries)
+{
+    std::vector<Jobs::Handle> jobs;
+    jobs.reserve(entries.size());
+
+    std::vector<Jobs::Handle> dependencies;
+    for (auto& entry : entries) {
+        dependencies.clear();
+        for (auto index : entry.dependencies) {
+            dependencies.push_back(jobs[index]);
+        }
+
+        auto affinity =
+            entry.access.main_thread_affinity ? Jobs::Affinity::MainThread : Jobs::Affinity::Any;
+        jobs.push_back(Jobs::schedule(
+            [&registry, &entry] { run_entry(registry, entry); }, dependencies, affinity));
+    }
+
+    for (auto const& job : jobs) {
+        Jobs::wait(job);
+    }
+}
+
+void Scheduler::run_validated(entt::registry& registry, std::vector<Entry>& entries)
+{
+    for (auto& entry : entries) {
+        auto before = storage_sizes(registry);
+        run_entry(registry, entry);
+
+        for (auto [id, storage] : registry.storage()) {
+            auto previous = before.find(id);
+            bool changed = previous == before.end() ? storage.size() != 0
+                                                    : previous->second != storage.size();
+
+            if (changed && !entry.access.writes_component(id)) {
+                spdlog::warn("System {} changed the {} components without declaring to write them",
+                             entry.name,
+                             storage.type().name());
+            }
+        }
+    }
+}
+
+void Scheduler::apply_commands(entt::registry& registry, std::vector<Entry>& entries)
+{
+    // Merged so that every component type is inserted into its pool once per stage
+    for (auto& entry : entries) {
+        stage_commands.append(std::move(entry.commands));
+    }
+
+    if (!stage_commands.empty()) {
+        stage_commands.apply(registry);
+    }
+}
+
+auto Scheduler::timings() const -> std::vector<Timing>
+{
+    std::vector<Timing> result;
+    for (std::size_t stage = 0; stage < STAGE_COUNT; ++stage) {
+        for (auto const& entry : stages.at(stage)) {
+            float average = entry.runs == 0 ? 0.0F
+                                            : static_cast<float>(entry.total_milliseconds /
+                                                                 static_cast<double>(entry.runs));
+            result.push_back(Timing{.name = entry.name,
+                                    .stage = static_cast<Stage>(stage),
+                                    .milliseconds = entry.milliseconds,
+                                    .average_milliseconds = average});
+        }
+    }
+    return result;
+}
+
+void Scheduler::reset_timings()
+{
+    for (auto& entries : stages) {
+        for (auto& entry : entries) {
+            entry.total_milliseconds = 0.0;
+            entry.runs = 0;
+        }
+    }
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "core/command_buffer.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <entt/entt.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Runs the systems of a frame in stages, one stage after another. Systems declare the components
+// and context variables they read and write. Within a stage, a system waits for the systems added
+// before it that access the same data with at least one of them writing, all other systems run
+// concurrently on the job pool.
+//
+// Systems must not create or destroy entities or add or remove components unless they are
+// exclusive. They record these changes into their command buffer instead, the buffers of a stage
+// are applied after it in the order the systems were added. Context variables have to exist
+// before the systems run, emplacing or erasing one while other systems look up theirs would race.
+class Scheduler
+{
+public:
+    enum class Stage
+    {
+        // Window and input state of the frame
+        PreUpdate,
+        // Simulation at a fixed rate, run once per fixed step of the frame
+        FixedUpdate,
+        // After every fixed step, e.g. propagating the transforms the step changed
+        FixedPostUpdate,
+        Update,
+        // Per-frame state is reset before rendering
+        PostUpdate,
+    };
+
+    static constexpr std::size_t STAGE_COUNT = 5;
+
+    using System = std::function<void(entt::registry&)>;
+    using DeferredSystem = std::function<void(entt::registry&, CommandBuffer&)>;
+
+    class Access
+    {
+    public:
+        template <typename Component> auto read() -> Access& { return component<Component>(reads); }
+        template <typename Component> auto write() -> Access&
+        {
+            return component<Component>(writes);
+        }
+
+        template <typename Variable> auto read_context() -> Access&
+        {
+            reads.push_back(Resource{.id = entt::type_hash<Variable>::value(), .context = true});
+            return *this;
+        }
+
+        template <typename Variable> auto write_context() -> Access&
+        {
+            writes.push_back(Resource{.id = entt::type_hash<Variable>::value(), .context = true});
+            return *this;
+        }
+
+        // For systems creating or destroying entities or touching data they cannot declare.
+        // Nothing else of the stage runs concurrently.
+        auto exclusive() -> Access&
+        {
+            exclusive_access = true;
+            return *this;
+        }
+
+        // For systems calling into GLFW or OpenGL
+        auto main_thread() -> Access&
+        {
+            main_thread_affinity = true;
+            return *this;
+        }
+
+    private:
+        friend class Scheduler;
+
+        struct Resource
+        {
+            entt::id_type id;
+            bool context;
+
+            auto operator==(Resource const&) const -> bool = default;
+        };
+
+        template <typename Component> auto component(std::vector<Resource>& resources) -> Access&
+        {
+            resources.push_back(
+                Resource{.id = entt::type_hash<Component>::value(), .context = false});
+            storages.push_back([](entt::registry& registry) { registry.storage<Component>(); });
+            return *this;
+        }
+
+        [[nodiscard]] auto conflicts(Access const& other) const -> bool;
+        [[nodiscard]] auto writes_component(entt::id_type id) const -> bool;
+
+        std::vector<Resource> reads;
+        std::vector<Resource> writes;
+
+        // Views create missing storage, which would race between concurrent systems. The storage
+        // of every declared component is created before the first run.
+        std::vector<void (*)(entt::registry&)> storages;
+
+        bool exclusive_access = false;
+        bool main_thread_affinity = false;
+    };
+
+    struct Timing
+    {
+        std::string name;
+        Stage stage;
+        float milliseconds;         // Last run
+        float average_milliseconds; // Since the last reset
+    };
+
+    void add(Stage stage, std::string name, Access access, System system);
+    void add(Stage stage, std::string name, Access access, DeferredSystem system);
+
+    // Call on the thread that started the job pool, it runs the systems with main thread affinity.
+    void run(entt::registry& registry, unsigned fixed_steps);
+
+    // Runs the systems one after another and reports the components a system adds to or removes
+    // from entities without declaring to write them. Changes of existing components go unnoticed.
+    void set_validation(bool enabled) { validation = enabled; }
+
+    // In the order the systems were added, stage by stage
+    [[nodiscard]] auto timings() const -> std::vector<Timing>;
+    void reset_timings();
+
+private:
+    struct Entry
+    {
+        char const* name; // Interned in names
+        Access access;
+        DeferredSystem system;
+        CommandBuffer commands{};
+
+        // Indices of the conflicting systems added before to the same stage
+        std::vector<std::size_t> dependencies{};
+
+        float milliseconds{};
+        double total_milliseconds{};
+        std::uint64_t runs{};
+    };
+
+    void prepare(entt::registry& registry);
+    void run_stage(entt::registry& registry, Stage stage);
+    void run_parallel(entt::registry& registry, std::vector<Entry>& entries);
+    void run_validated(entt::registry& registry, std::vector<Entry>& entries);
+    void apply_commands(entt::registry& registry, std::vector<Entry>& entries);
+
+    static void run_entry(entt::registry& registry, Entry& entry);
+
+    // Profiling zones keep their names until the trace is written. The deque does not move its
+    // strings when it grows, unlike the entries.
+    std::deque<std::string> names;
+
+    std::array<std::vector<Entry>, STAGE_COUNT> stages;
+    CommandBuffer stage_commands;
+    bool prepared = false;
+    bool validation = false;
+};
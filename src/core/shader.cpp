@@ -1,23 +1,51 @@
 #include "shader.h"
+#include "core/graphics/gl_queue.h"
+#include "core/graphics/gl_state.h"
 
+#include <array>
 #include <fstream>
 #include <glm/gtc/type_ptr.hpp>
 #include <spdlog/spdlog.h>
 
 Shader::Shader(std::string_view name, std::filesystem::path const& directory)
-    : program(glCreateProgram())
+    : Shader(name, name, directory)
 {
-    std::filesystem::path vertex_shader_path = directory / name;
+}
+
+Shader::Shader(std::string_view vertex_name,
+               std::string_view fragment_name,
+               std::filesystem::path const& directory)
+{
+    std::filesystem::path vertex_shader_path = directory / vertex_name;
     vertex_shader_path.concat(".vert");
 
-    std::filesystem::path frag_shader_path = directory / name;
+    std::filesystem::path frag_shader_path = directory / fragment_name;
     frag_shader_path.concat(".frag");
 
-    std::string vertex_shader_source = parse(vertex_shader_path);
-    std::string fragment_shader_source = parse(frag_shader_path);
+    std::string name = std::string(vertex_name) + "/" + std::string(fragment_name);
+    link(parse(vertex_shader_path), parse(frag_shader_path), name);
+}
+
+auto Shader::from_fragment_source(std::string_view vertex_name,
+                                  std::string const& fragment_source,
+                                  std::filesystem::path const& directory) -> Shader
+{
+    std::filesystem::path vertex_shader_path = directory / vertex_name;
+    vertex_shader_path.concat(".vert");
+
+    Shader shader;
+    shader.link(parse(vertex_shader_path), fragment_source, vertex_name);
+    return shader;
+}
+
+void Shader::link(std::string const& vertex_source,
+                  std::string const& fragment_source,
+                  std::string_view name)
+{
+    program = glCreateProgram();
 
-    GLuint vertex_shader = compile(vertex_shader_source, GL_VERTEX_SHADER);
-    GLuint fragment_shader = compile(fragment_shader_source, GL_FRAGMENT_SHADER);
+    GLuint vertex_shader = compile(vertex_source, GL_VERTEX_SHADER);
+    GLuint fragment_shader = compile(fragment_source, GL_FRAGMENT_SHADER);
 
     glAttachShader(program, vertex_shader);
     glAttachShader(program, fragment_shader);
@@ -29,6 +57,8 @@ Shader::Shader(std::string_view name, std::filesystem::path const& directory)
 
     if (linked == 0) {
         spdlog::warn(R"(Failed to link Shader "{}")", name);
+    } else {
+        introspect();
     }
 
 #ifdef NDEBUG
@@ -44,17 +74,17 @@ Shader::Shader(std::string_view name, std::filesystem::path const& directory)
 
 Shader::~Shader()
 {
-    glDeleteProgram(program);
+    GlState::delete_program(program);
 }
 
 void Shader::bind() const
 {
-    glUseProgram(program);
+    GlState::use_program(program);
 }
 
 void Shader::unbind()
 {
-    glUseProgram(0);
+    GlState::use_program(0);
 }
 
 auto Shader::parse(std::filesystem::path const& path) -> std::string
@@ -67,7 +97,23 @@ auto Shader::parse(std::filesystem::path const& path) -> std::string
         std::terminate();
     }
 
-    return {(std::istreambuf_iterator<char>(file)), (std::istreambuf_iterator<char>())};
+    // Lines of the form #include "file" are replaced by the file, relative to the including one.
+    static constexpr std::string_view INCLUDE_DIRECTIVE{"#include \""};
+
+    std::string source;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.starts_with(INCLUDE_DIRECTIVE)) {
+            auto include_name = line.substr(INCLUDE_DIRECTIVE.size());
+            include_name = include_name.substr(0, include_name.find('"'));
+            source += parse(path.parent_path() / include_name);
+        } else {
+            source += line;
+            source += '\n';
+        }
+    }
+
+    return source;
 }
 
 auto Shader::compile(std::string_view source, GLenum type) -> GLuint
@@ -96,50 +142,193 @@ auto Shader::compile(std::string_view source, GLenum type) -> GLuint
     return program;
 }
 
-auto Shader::retrieveUniformLocation(std::string_view uniform_name) const -> GLint
+void Shader::introspect()
 {
-    if (uniform_location_cache.find(uniform_name.data()) != uniform_location_cache.end()) {
-        return uniform_location_cache[uniform_name.data()];
+    auto register_uniform = [this](std::string_view name, UniformInfo info) {
+        uniforms[entt::hashed_string::value(name.data(), name.size())] = info;
+    };
+
+    GLint max_name_length{};
+    glGetProgramInterfaceiv(program, GL_UNIFORM, GL_MAX_NAME_LENGTH, &max_name_length);
+    std::string name(static_cast<std::size_t>(max_name_length), '\0');
+
+    GLint uniform_count{};
+    glGetProgramInterfaceiv(program, GL_UNIFORM, GL_ACTIVE_RESOURCES, &uniform_count);
+
+    for (GLint index = 0; index < uniform_count; ++index) {
+        static constexpr std::array<GLenum, 3> PROPERTIES{GL_LOCATION, GL_TYPE, GL_ARRAY_SIZE};
+        std::array<GLint, PROPERTIES.size()> values{};
+
+        glGetProgramResourceiv(program,
+                               GL_UNIFORM,
+                               static_cast<GLuint>(index),
+                               PROPERTIES.size(),
+                               PROPERTIES.data(),
+                               values.size(),
+                               nullptr,
+                               values.data());
+
+        auto [location, type, array_size] = values;
+
+        // Members of uniform blocks have no location.
+        if (location == -1) {
+            continue;
+        }
+
+        GLsizei length{};
+        glGetProgramResourceName(
+            program, GL_UNIFORM, static_cast<GLuint>(index), max_name_length, &length, name.data());
+        std::string_view resource_name(name.data(), static_cast<std::size_t>(length));
+
+        UniformInfo info{.location = location, .type = static_cast<GLenum>(type)};
+
+        // Arrays of basic types are reported once, named after their first element. Their
+        // elements have consecutive locations.
+        if (resource_name.ends_with("[0]")) {
+            auto base_name = resource_name.substr(0, resource_name.size() - 3);
+            register_uniform(base_name, info);
+
+            for (GLint element = 0; element < array_size; ++element) {
+                register_uniform(fmt::format("{}[{}]", base_name, element),
+                                 UniformInfo{.location = location + element, .type = info.type});
+            }
+        } else {
+            register_uniform(resource_name, info);
+        }
     }
 
-    GLint location = glGetUniformLocation(program, uniform_name.data());
+    for (GLenum interface : {GL_UNIFORM_BLOCK, GL_SHADER_STORAGE_BLOCK}) {
+        glGetProgramInterfaceiv(program, interface, GL_MAX_NAME_LENGTH, &max_name_length);
+        name.resize(static_cast<std::size_t>(max_name_length));
+
+        GLint block_count{};
+        glGetProgramInterfaceiv(program, interface, GL_ACTIVE_RESOURCES, &block_count);
+
+        for (GLint index = 0; index < block_count; ++index) {
+            GLenum const property = GL_BUFFER_BINDING;
+            GLint binding{};
+            glGetProgramResourceiv(
+                program, interface, static_cast<GLuint>(index), 1, &property, 1, nullptr, &binding);
+
+            GLsizei length{};
+            glGetProgramResourceName(program,
+                                     interface,
+                                     static_cast<GLuint>(index),
+                                     max_name_length,
+                                     &length,
+                                     name.data());
+
+            std::string_view block_name(name.data(), static_cast<std::size_t>(length));
+            block_bindings[entt::hashed_string::value(block_name.data(), block_name.size())] =
+                static_cast<GLuint>(binding);
+        }
+    }
+}
 
-    if (location != -1) {
-        uniform_location_cache[uniform_name.data()] = location;
-    } else {
-        spdlog::warn(R"(Uniform "{}" not found.)", uniform_name);
+template <typename T> static auto type_matches(GLenum type) -> bool
+{
+    if constexpr (std::is_same_v<T, bool>) {
+        return type == GL_BOOL;
+    } else if constexpr (std::is_same_v<T, int>) {
+        return type == GL_INT || type == GL_SAMPLER_2D || type == GL_SAMPLER_2D_SHADOW ||
+               type == GL_SAMPLER_2D_ARRAY || type == GL_SAMPLER_2D_ARRAY_SHADOW ||
+               type == GL_SAMPLER_3D || type == GL_SAMPLER_CUBE;
+    } else if constexpr (std::is_same_v<T, unsigned>) {
+        return type == GL_UNSIGNED_INT;
+    } else if constexpr (std::is_same_v<T, float>) {
+        return type == GL_FLOAT;
+    } else if constexpr (std::is_same_v<T, glm::vec2>) {
+        return type == GL_FLOAT_VEC2;
+    } else if constexpr (std::is_same_v<T, glm::vec3>) {
+        return type == GL_FLOAT_VEC3;
+    } else if constexpr (std::is_same_v<T, glm::mat3>) {
+        return type == GL_FLOAT_MAT3;
+    } else if constexpr (std::is_same_v<T, glm::mat4>) {
+        return type == GL_FLOAT_MAT4;
     }
+}
+
+template <typename T> auto Shader::uniform(entt::id_type name) const -> Uniform<T>
+{
+    auto it = uniforms.find(name);
 
-    return location;
+    if (it == uniforms.cend()) {
+        spdlog::warn("Uniform {:#x} not found.", name);
+        return {};
+    }
+
+    if (!type_matches<T>(it->second.type)) {
+        spdlog::warn("Uniform {:#x} has a mismatching type {:#x}.", name, it->second.type);
+        return {};
+    }
+
+    return Uniform<T>{.location = it->second.location};
 }
 
-template <typename T> void Shader::set_uniform(std::string_view name, T value) const
+template <typename T> void Shader::set_uniform(Uniform<T> uniform, T value) const
 {
-    GLint location = retrieveUniformLocation(name);
+    GLint location = uniform.location;
 
     if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, int>) {
-        glUniform1i(location, (int)value);
+        glProgramUniform1i(program, location, (int)value);
     } else if constexpr (std::is_same_v<T, unsigned>) {
-        glUniform1ui(location, value);
+        glProgramUniform1ui(program, location, value);
     } else if constexpr (std::is_same_v<T, float>) {
-        glUniform1f(location, value);
+        glProgramUniform1f(program, location, value);
     } else if constexpr (std::is_same_v<T, glm::vec2>) {
-        glUniform2f(location, value.x, value.y); // NOLINT(cppcoreguidelines-pro-type-union-access)
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-union-access)
+        glProgramUniform2f(program, location, value.x, value.y);
     } else if constexpr (std::is_same_v<T, glm::vec3>) {
-        glUniform3f(
-            location, value.x, value.y, value.z); // NOLINT(cppcoreguidelines-pro-type-union-access)
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-union-access)
+        glProgramUniform3f(program, location, value.x, value.y, value.z);
     } else if constexpr (std::is_same_v<T, glm::mat3>) {
-        glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
+        glProgramUniformMatrix3fv(program, location, 1, GL_FALSE, glm::value_ptr(value));
     } else if constexpr (std::is_same_v<T, glm::mat4>) {
-        glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+        glProgramUniformMatrix4fv(program, location, 1, GL_FALSE, glm::value_ptr(value));
     }
 }
 
-template void Shader::set_uniform(std::string_view, bool) const;
-template void Shader::set_uniform(std::string_view, int) const;
-template void Shader::set_uniform(std::string_view, unsigned) const;
-template void Shader::set_uniform(std::string_view, float) const;
-template void Shader::set_uniform(std::string_view, glm::vec2) const;
-template void Shader::set_uniform(std::string_view, glm::vec3) const;
-template void Shader::set_uniform(std::string_view, glm::mat3) const;
-template void Shader::set_uniform(std::string_view, glm::mat4) const;
+auto Shader::block_binding(entt::id_type name) const -> std::optional<GLuint>
+{
+    auto it = block_bindings.find(name);
+
+    if (it == block_bindings.cend()) {
+        return {};
+    }
+
+    return it->second;
+}
+
+template auto Shader::uniform<bool>(entt::id_type) const -> Uniform<bool>;
+template auto Shader::uniform<int>(entt::id_type) const -> Uniform<int>;
+template auto Shader::uniform<unsigned>(entt::id_type) const -> Uniform<unsigned>;
+template auto Shader::uniform<float>(entt::id_type) const -> Uniform<float>;
+template auto Shader::uniform<glm::vec2>(entt::id_type) const -> Uniform<glm::vec2>;
+template auto Shader::uniform<glm::vec3>(entt::id_type) const -> Uniform<glm::vec3>;
+template auto Shader::uniform<glm::mat3>(entt::id_type) const -> Uniform<glm::mat3>;
+template auto Shader::uniform<glm::mat4>(entt::id_type) const -> Uniform<glm::mat4>;
+
+template void Shader::set_uniform(Uniform<bool>, bool) const;
+template void Shader::set_uniform(Uniform<int>, int) const;
+template void Shader::set_uniform(Uniform<unsigned>, unsigned) const;
+template void Shader::set_uniform(Uniform<float>, float) const;
+template void Shader::set_uniform(Uniform<glm::vec2>, glm::vec2) const;
+template void Shader::set_uniform(Uniform<glm::vec3>, glm::vec3) const;
+template void Shader::set_uniform(Uniform<glm::mat3>, glm::mat3) const;
+template void Shader::set_uniform(Uniform<glm::mat4>, glm::mat4) const;
+
+auto ShaderLoader::operator()(std::string_view name) -> result_type
+{
+    return (*this)(name, name);
+}
+
+auto ShaderLoader::operator()(std::string_view vertex_name, std::string_view fragment_name)
+    -> result_type
+{
+    auto shader = GlQueue::share(new Shader);
+    GlQueue::submit(
+        [shader, vertex = std::string(vertex_name), fragment = std::string(fragment_name)] {
+            *shader = Shader(vertex, fragment, shader_directory);
+        });
+    return shader;
+}
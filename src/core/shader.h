@@ -1,50 +1,102 @@
 #pragma once
 
+#include "core/graphics/gl_state.h"
+
+#include <entt/entt.hpp>
 #include <filesystem>
 #include <glad/gl.h>
 #include <glm/glm.hpp>
+#include <optional>
+#include <string>
 #include <string_view>
 #include <unordered_map>
 
+// Typed handle to a uniform of the default uniform block. Setting an invalid handle is a no-op.
+template <typename T> struct Uniform
+{
+    GLint location = -1;
+};
+
 struct Shader
 {
+    // Has no program until one is moved in.
+    Shader() = default;
     Shader(std::string_view name, std::filesystem::path const &directory);
+    Shader(std::string_view vertex_name,
+           std::string_view fragment_name,
+           std::filesystem::path const &directory);
 
     Shader(Shader const &) = delete;
     auto operator=(Shader const &) -> Shader & = delete;
 
-    Shader(Shader &&other) noexcept : program(other.program) { other.program = 0; }
+    Shader(Shader &&other) noexcept
+        : program(other.program),
+          uniforms(std::move(other.uniforms)),
+          block_bindings(std::move(other.block_bindings))
+    {
+        other.program = 0;
+    }
     auto operator=(Shader &&other) noexcept -> Shader &
     {
+        GlState::delete_program(program);
+
         program = other.program;
+        uniforms = std::move(other.uniforms);
+        block_bindings = std::move(other.block_bindings);
         other.program = 0;
         return *this;
     };
 
     ~Shader();
 
+    // Pairs a vertex shader file with a fragment shader generated at runtime.
+    static auto from_fragment_source(std::string_view vertex_name,
+                                     std::string const &fragment_source,
+                                     std::filesystem::path const &directory) -> Shader;
+
     void bind() const;
     static void unbind();
 
+    // Resolves a uniform by its hashed name, e.g. "u_material.texture_diffuse"_hs. Elements of
+    // arrays are named with their index, e.g. "u_pointLight[0].color"_hs. Handles stay valid
+    // for the lifetime of the shader and should be resolved once rather than per draw.
     template <typename T>
-    void set_uniform(std::string_view name, T value) const;
+    [[nodiscard]] auto uniform(entt::id_type name) const -> Uniform<T>;
+
+    // Sets the uniform without requiring the program to be bound.
+    template <typename T>
+    void set_uniform(Uniform<T> uniform, T value) const;
+
+    // Binding point of a uniform or shader storage block.
+    [[nodiscard]] auto block_binding(entt::id_type name) const -> std::optional<GLuint>;
 
 private:
-    auto retrieveUniformLocation(std::string_view uniform_name) const -> GLint;
+    struct UniformInfo
+    {
+        GLint location;
+        GLenum type;
+    };
+
+    void link(std::string const &vertex_source,
+              std::string const &fragment_source,
+              std::string_view name);
+    void introspect();
     static auto parse(const std::filesystem::path &path) -> std::string;
     static auto compile(std::string_view source, GLenum type) -> GLuint;
 
-    GLuint program;
-    mutable std::unordered_map<std::string, GLint> uniform_location_cache;
+    GLuint program{};
+
+    std::unordered_map<entt::id_type, UniformInfo> uniforms;
+    std::unordered_map<entt::id_type, GLuint> block_bindings;
 };
 
+// Shaders are compiled and deleted on the thread owning the GL context, so that they can also
+// be loaded while the render thread draws.
 struct ShaderLoader
 {
     using result_type = std::shared_ptr<Shader>;
     static constexpr std::string_view shader_directory{"data/shaders"};
 
-    auto operator()(std::string_view name) -> result_type
-    {
-        return std::make_shared<Shader>(name, shader_directory);
-    }
+    auto operator()(std::string_view name) -> result_type;
+    auto operator()(std::string_view vertex_name, std::string_view fragment_name) -> result_type;
 };
@@ -0,0 +1,472 @@
+#include "shadows.h"
+#include "components/transform.h"
+#include "core/camera.h"
+#include "core/graphics/buffer.h"
+#include "core/graphics/geometry_pool.h"
+#include "core/graphics/mesh.h"
+#include "core/graphics/ring_buffer.h"
+#include "core/graphics/shadow_map.h"
+#include "core/light.h"
+#include "core/render.h"
+#include "core/shader.h"
+
+#include <algorithm>
+#include <bit>
+#include <glm/gtc/matrix_transform.hpp>
+#include <optional>
+#include <span>
+#include <vector>
+
+using namespace entt::literals;
+
+namespace {
+
+using Shadows::CASCADE_COUNT;
+
+// A cascade is moved in steps of this fraction of its size. Its extent includes one step of
+// margin, so it only has to follow the camera once the view moved a full step.
+constexpr float SNAP_DIVISIONS = 8.0;
+
+// Shadow data of the frame as laid out in the ShadowBuffer of the lighting (std140).
+struct ShadowData
+{
+    std::array<glm::mat4, CASCADE_COUNT> cascade_view_projection_matrices;
+    glm::vec4 cascade_splits;
+    glm::vec4 cascade_texel_sizes;
+    glm::vec4 shadow_params;
+};
+
+static_assert(CASCADE_COUNT == 4, "ShadowData packs per-cascade values into a vec4");
+
+// Per-draw data as laid out in the DrawDataBuffer of the shadow shader (std430).
+struct DrawData
+{
+    glm::mat4 model_matrix;
+};
+
+struct Caster
+{
+    GpuMesh const* mesh;
+    glm::mat4 model_matrix;
+
+    // Bounding sphere in light space.
+    glm::vec3 center;
+    float radius;
+
+    // Identifies the entity, its mesh and its transform for change detection.
+    std::uint64_t hash;
+    bool dynamic;
+};
+
+struct Cascade
+{
+    // Light view projection, far view depth and texel size of the current shadow map layer.
+    glm::mat4 view_projection{};
+    float split{};
+    float texel_size{};
+
+    // Light view projection and casters the static cache was drawn with.
+    std::optional<glm::mat4> static_view_projection;
+    std::uint64_t static_hash{};
+
+    std::optional<std::uint64_t> last_update;
+    bool has_dynamic_casters{};
+
+    // Casters of the current frame, reused between frames to avoid reallocations.
+    std::vector<std::uint32_t> static_casters;
+    std::vector<std::uint32_t> dynamic_casters;
+};
+
+// A cascade that is drawn this frame.
+struct CascadeUpdate
+{
+    std::size_t cascade;
+    glm::mat4 view_projection;
+    float split;
+    float texel_size;
+    bool update_static;
+};
+
+struct ShadowContext
+{
+    static constexpr GLuint SHADOW_DATA_BINDING = 2;
+    static constexpr GLuint DRAW_DATA_BINDING = 0;
+
+    Shader shader{"shadow", ShaderLoader::shader_directory};
+    Uniform<glm::mat4> view_projection_uniform =
+        shader.uniform<glm::mat4>("u_lightViewProjectionMatrix"_hs);
+
+    std::optional<ShadowMap> shadow_map;
+    Buffer shadow_data{GL_UNIFORM_BUFFER};
+    RingBuffer frame_data;
+
+    std::array<Cascade, CASCADE_COUNT> cascades;
+    std::uint64_t frame{};
+
+    // Reused between frames to avoid reallocations.
+    std::vector<Caster> casters;
+    std::vector<CascadeUpdate> updates;
+};
+
+auto hash_combine(std::uint64_t seed, std::uint64_t value) -> std::uint64_t
+{
+    return seed ^ (value + 0x9E3779B97F4A7C15 + (seed << 6) + (seed >> 2));
+}
+
+auto caster_hash(entt::entity entity, GpuMesh const& mesh, glm::mat4 const& model_matrix)
+    -> std::uint64_t
+{
+    std::uint64_t hash = hash_combine(entt::to_integral(entity), mesh.id);
+    for (glm::length_t column = 0; column < 4; ++column) {
+        for (glm::length_t row = 0; row < 4; ++row) {
+            hash = hash_combine(hash, std::bit_cast<std::uint32_t>(model_matrix[column][row]));
+        }
+    }
+
+    return hash;
+}
+
+// Bounding sphere in view space of the part of the view frustum between two view depths.
+auto slice_bounds(glm::mat4 const& inverse_projection, float near_depth, float far_depth)
+    -> glm::vec4
+{
+    auto unproject = [&inverse_projection](float x, float y, float ndc_depth) {
+        glm::vec4 position = inverse_projection * glm::vec4(x, y, ndc_depth, 1.0F);
+        return glm::vec3(position) / position.w;
+    };
+
+    std::array<glm::vec3, 8> corners{};
+    std::size_t corner = 0;
+    for (float x : {-1.0F, 1.0F}) {
+        for (float y : {-1.0F, 1.0F}) {
+            glm::vec3 near_point = unproject(x, y, -1.0F);
+            glm::vec3 far_point = unproject(x, y, 1.0F);
+
+            for (float depth : {near_depth, far_depth}) {
+                float t = (depth + near_point.z) / (near_point.z - far_point.z);
+                corners.at(corner++) = near_point + (far_point - near_point) * t;
+            }
+        }
+    }
+
+    glm::vec3 center{};
+    for (auto const& point : corners) {
+        center += point / static_cast<float>(corners.size());
+    }
+
+    float radius = 0.0;
+    for (auto const& point : corners) {
+        radius = std::max(radius, glm::length(point - center));
+    }
+
+    // The radius only depends on the projection, rounding it keeps it stable between frames.
+    return {center, std::ceil(radius * 16.0F) / 16.0F};
+}
+
+// Light space box covered by a cascade.
+struct CascadeBox
+{
+    glm::vec3 min;
+    glm::vec3 max;
+    float extent;
+};
+
+// Box around the bounding sphere of a cascade, snapped to steps of a fraction of its size.
+// Snapping keeps the box constant while the camera moves within a step, which keeps the
+// static cache valid and avoids shimmering edges, as the texel grid does not move.
+auto cascade_box(glm::vec3 light_space_center, float radius, float caster_distance) -> CascadeBox
+{
+    float const half_extent = radius * SNAP_DIVISIONS / (SNAP_DIVISIONS - 1.0F);
+    float const step = 2.0F * half_extent / SNAP_DIVISIONS;
+    glm::vec3 const center = glm::round(light_space_center / step) * step;
+
+    // The light looks down the negative z axis of light space, casters between the light and
+    // the cascade have a larger z.
+    return {.min = center - half_extent,
+            .max = center + glm::vec3(half_extent, half_extent, half_extent + caster_distance),
+            .extent = 2.0F * half_extent};
+}
+
+auto cascade_projection(CascadeBox const& box) -> glm::mat4
+{
+    return glm::ortho(box.min.x, box.max.x, box.min.y, box.max.y, -box.max.z, -box.min.z);
+}
+
+auto directional_light_view(glm::vec3 direction) -> glm::mat4
+{
+    glm::vec3 up = std::abs(direction.y) > 0.99F ? glm::vec3(1.0, 0.0, 0.0) : Camera::UP_VECTOR;
+    return glm::lookAt(glm::vec3(0.0), direction, up);
+}
+
+void draw(GeometryPool const& geometry_pool,
+          std::span<std::uint32_t const> caster_indices,
+          std::span<Caster const> casters,
+          std::span<DrawData> draw_data,
+          std::size_t& draw_index,
+          Shadows::Stats& stats)
+{
+    for (auto caster_index : caster_indices) {
+        auto const& caster = casters[caster_index];
+        auto const& mesh = *caster.mesh;
+
+        draw_data[draw_index] = DrawData{.model_matrix = caster.model_matrix};
+
+        GlState::bind_vertex_array(geometry_pool.vertex_array(mesh.layout));
+        glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES,
+                                                      mesh.indices_count,
+                                                      mesh.indices_type,
+                                                      mesh.indices_offset(),
+                                                      1,
+                                                      mesh.base_vertex,
+                                                      static_cast<GLuint>(draw_index));
+        ++draw_index;
+        ++stats.draw_calls;
+        stats.triangles += static_cast<std::uint64_t>(mesh.indices_count / 3);
+    }
+}
+
+} // namespace
+
+void Shadows::render(entt::registry& registry)
+{
+    auto& stats = registry.ctx().get<Stats>();
+    stats = {};
+
+    auto const& settings = registry.ctx().get<Settings>();
+    auto& context = registry.ctx().emplace<ShadowContext>();
+
+    ShadowData shadow_data{.cascade_view_projection_matrices = {},
+                           .cascade_splits = glm::vec4(0.0),
+                           .cascade_texel_sizes = glm::vec4(0.0),
+                           .shadow_params = glm::vec4(0.0)};
+
+    auto camera_view = registry.view<Camera const, GlobalTransform const>();
+    auto light_view = registry.view<DirectionalLight const, GlobalTransform const>();
+    auto camera_entity = camera_view.front();
+    auto light_entity = light_view.front();
+
+    bool const active = settings.enabled && camera_entity != entt::null &&
+                        light_entity != entt::null &&
+                        light_view.get<DirectionalLight const>(light_entity).illuminance != 0.0F;
+
+    if (!active) {
+        context.shadow_data.upload(&shadow_data, sizeof(ShadowData));
+        context.shadow_data.bind_base(ShadowContext::SHADOW_DATA_BINDING);
+        return;
+    }
+
+    ++context.frame;
+
+    auto resolution = static_cast<GLsizei>(settings.resolution);
+    if (!context.shadow_map.has_value() || context.shadow_map->resolution() != resolution) {
+        context.shadow_map.emplace(resolution, static_cast<GLsizei>(CASCADE_COUNT));
+        context.cascades = {};
+    }
+
+    // A moving light changes the projection of every cascade, which invalidates their caches.
+    auto const& light_transform = light_view.get<GlobalTransform const>(light_entity);
+    glm::vec3 light_direction =
+        glm::normalize(glm::vec3(light_transform.transform * glm::vec4(1.0, 0.0, 0.0, 0.0)));
+    glm::mat4 light_view_matrix = directional_light_view(light_direction);
+
+    // Casters
+    context.casters.clear();
+
+    auto caster_view = registry.view<GpuMesh const, GlobalTransform const>();
+    for (auto [entity, mesh, transform] : caster_view.each()) {
+        auto const& model_matrix = transform.transform;
+        float const scale = std::max({glm::length(glm::vec3(model_matrix[0])),
+                                      glm::length(glm::vec3(model_matrix[1])),
+                                      glm::length(glm::vec3(model_matrix[2]))});
+
+        glm::vec4 center = model_matrix * glm::vec4(glm::vec3(mesh.bounding_sphere), 1.0);
+
+        context.casters.push_back(
+            Caster{.mesh = &mesh,
+                   .model_matrix = model_matrix,
+                   .center = glm::vec3(light_view_matrix * center),
+                   .radius = mesh.bounding_sphere.w * scale,
+                   .hash = caster_hash(entity, mesh, model_matrix),
+                   .dynamic = registry.all_of<DynamicShadowCaster>(entity)});
+    }
+
+    // Cascades
+    auto [camera, camera_transform] = camera_view.get(camera_entity);
+    glm::mat4 inverse_view_matrix = glm::inverse(Camera::view_matrix(camera_transform));
+    glm::mat4 inverse_projection_matrix = glm::inverse(camera.projection_matrix());
+    auto [near_plane, far_plane] = std::visit(
+        [](auto const& projection) { return std::pair(projection.near, projection.far); },
+        camera.projection);
+
+    float const shadow_distance = std::min(settings.distance, far_plane);
+
+    context.updates.clear();
+    unsigned planned_draws = 0;
+    float split_near = near_plane;
+
+    for (std::size_t i = 0; i < CASCADE_COUNT; ++i) {
+        auto& cascade = context.cascades.at(i);
+
+        // Practical split scheme, blending logarithmic and uniform splits.
+        float const fraction = static_cast<float>(i + 1) / CASCADE_COUNT;
+        float const log_split = near_plane * std::pow(shadow_distance / near_plane, fraction);
+        float const uniform_split = near_plane + (shadow_distance - near_plane) * fraction;
+        float const split = glm::mix(uniform_split, log_split, settings.split_lambda);
+
+        glm::vec4 bounds = slice_bounds(inverse_projection_matrix, split_near, split);
+        split_near = split;
+
+        glm::vec3 center =
+            light_view_matrix * inverse_view_matrix * glm::vec4(glm::vec3(bounds), 1.0);
+        CascadeBox box = cascade_box(center, bounds.w, settings.caster_distance);
+        glm::mat4 view_projection = cascade_projection(box) * light_view_matrix;
+
+        cascade.static_casters.clear();
+        cascade.dynamic_casters.clear();
+        std::uint64_t static_hash = 0;
+
+        for (std::uint32_t caster_index = 0; caster_index < context.casters.size();
+             ++caster_index) {
+            auto const& caster = context.casters[caster_index];
+
+            glm::vec3 closest = glm::clamp(caster.center, box.min, box.max);
+            glm::vec3 offset = caster.center - closest;
+            if (glm::dot(offset, offset) > caster.radius * caster.radius) {
+                continue;
+            }
+
+            if (caster.dynamic) {
+                cascade.dynamic_casters.push_back(caster_index);
+            } else {
+                cascade.static_casters.push_back(caster_index);
+                static_hash = hash_combine(static_hash, caster.hash);
+            }
+        }
+
+        bool const update_static = cascade.static_view_projection != view_projection ||
+                                   cascade.static_hash != static_hash;
+        bool const up_to_date = !update_static && cascade.dynamic_casters.empty() &&
+                                !cascade.has_dynamic_casters &&
+                                cascade.view_projection == view_projection;
+        bool const due = !cascade.last_update.has_value() ||
+                         context.frame - cascade.last_update.value() >=
+                             std::max(settings.update_intervals.at(i), 1U);
+
+        if (up_to_date || !due) {
+            continue;
+        }
+
+        auto draws = static_cast<unsigned>(cascade.dynamic_casters.size() +
+                                           (update_static ? cascade.static_casters.size() : 0));
+
+        if (!context.updates.empty() && planned_draws + draws > settings.draw_budget) {
+            ++stats.cascades_postponed;
+            continue;
+        }
+
+        planned_draws += draws;
+        cascade.static_hash = static_hash;
+        context.updates.push_back(CascadeUpdate{.cascade = i,
+                                                .view_projection = view_projection,
+                                                .split = split,
+                                                .texel_size = box.extent /
+                                                              static_cast<float>(resolution),
+                                                .update_static = update_static});
+    }
+
+    // Drawing
+    if (!context.updates.empty()) {
+        auto& frame_data = context.frame_data;
+        std::span<DrawData> draw_data;
+
+        if (planned_draws > 0) {
+            auto const draw_data_size = static_cast<GLsizeiptr>(planned_draws * sizeof(DrawData));
+
+            frame_data.begin_frame(frame_data.aligned(draw_data_size));
+            auto draw_data_allocation = frame_data.allocate(draw_data_size);
+            draw_data = std::span(static_cast<DrawData*>(draw_data_allocation.data), planned_draws);
+
+            GlState::bind_buffer_range(GL_SHADER_STORAGE_BUFFER,
+                                       ShadowContext::DRAW_DATA_BINDING,
+                                       frame_data.buffer(),
+                                       draw_data_allocation.offset,
+                                       draw_data_allocation.size);
+            registry.ctx().get<GeometryPool>().reserve_draw_ids(planned_draws);
+        }
+
+        GLuint const target_frame_buffer = GlState::framebuffer();
+
+        glViewport(0, 0, resolution, resolution);
+
+        // Slope scaled depth bias against shadow acne.
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(2.0F, 4.0F);
+
+        context.shader.bind();
+
+        auto const& shadow_map = context.shadow_map.value();
+        auto const& geometry_pool = registry.ctx().get<GeometryPool>();
+        std::size_t draw_index = 0;
+
+        for (auto const& update : context.updates) {
+            auto& cascade = context.cascades.at(update.cascade);
+            auto layer = static_cast<GLint>(update.cascade);
+
+            context.shader.set_uniform(context.view_projection_uniform, update.view_projection);
+
+            if (update.update_static) {
+                shadow_map.begin_static(layer);
+                draw(geometry_pool,
+                     cascade.static_casters,
+                     context.casters,
+                     draw_data,
+                     draw_index,
+                     stats);
+
+                cascade.static_view_projection = update.view_projection;
+                ++stats.static_caches_updated;
+            }
+
+            shadow_map.begin_dynamic(layer);
+            draw(geometry_pool,
+                 cascade.dynamic_casters,
+                 context.casters,
+                 draw_data,
+                 draw_index,
+                 stats);
+
+            cascade.view_projection = update.view_projection;
+            cascade.split = update.split;
+            cascade.texel_size = update.texel_size;
+            cascade.last_update = context.frame;
+            cascade.has_dynamic_casters = !cascade.dynamic_casters.empty();
+            ++stats.cascades_updated;
+        }
+
+        glDisable(GL_POLYGON_OFFSET_FILL);
+
+        auto dimensions = registry.ctx().get<Render::Viewport>().dimensions;
+        GlState::bind_framebuffer(target_frame_buffer);
+        glViewport(0, 0, static_cast<GLsizei>(dimensions.x), static_cast<GLsizei>(dimensions.y));
+
+        if (planned_draws > 0) {
+            frame_data.end_frame();
+        }
+    }
+
+    // The lighting uses the cascades as they were last drawn, which may lag behind the camera.
+    for (std::size_t i = 0; i < CASCADE_COUNT; ++i) {
+        auto const& cascade = context.cascades.at(i);
+        auto component = static_cast<glm::length_t>(i);
+
+        shadow_data.cascade_view_projection_matrices.at(i) = cascade.view_projection;
+        shadow_data.cascade_splits[component] = cascade.split;
+        shadow_data.cascade_texel_sizes[component] = cascade.texel_size;
+    }
+
+    shadow_data.shadow_params.x = 1.0;
+
+    context.shadow_data.upload(&shadow_data, sizeof(ShadowData));
+    context.shadow_data.bind_base(ShadowContext::SHADOW_DATA_BINDING);
+    context.shadow_map->bind();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <entt/entt.hpp>
+
+// Tags a shadow caster that moves frequently. Dynamic casters are drawn every time their cascade
+// is updated, all other casters are cached per cascade and only drawn again when they change.
+struct DynamicShadowCaster
+{
+};
+
+namespace Shadows {
+
+static constexpr std::size_t CASCADE_COUNT = 4;
+
+struct Settings
+{
+    bool enabled = true;
+
+    // Size of a cascade in texels. Has to be a multiple of 8, the cascades are moved in steps
+    // of an eighth of their size.
+    std::uint32_t resolution = 2048;
+
+    // View depth at which the last cascade ends.
+    float distance = 100.0;
+
+    // Blend between uniform (0) and logarithmic (1) cascade splits.
+    float split_lambda = 0.75;
+
+    // Distance towards the light in front of a cascade in which casters are still drawn.
+    float caster_distance = 100.0;
+
+    // Frames between two updates of a cascade. Distant cascades cover more of the scene per
+    // texel, so the lag of a slower update is less visible there.
+    std::array<unsigned, CASCADE_COUNT> update_intervals{1, 1, 2, 4};
+
+    // Shadow draw calls per frame. Cascades that would exceed the budget are postponed to a
+    // later frame, except for the first cascade updated in a frame.
+    unsigned draw_budget = 1000;
+};
+
+// Work done by the last call to render().
+struct Stats
+{
+    unsigned draw_calls{};
+    unsigned cascades_updated{};
+    unsigned static_caches_updated{};
+    unsigned cascades_postponed{};
+    std::uint64_t triangles{};
+};
+
+// Updates the cascaded shadow maps of the directional light and binds them for lighting.
+void render(entt::registry& registry);
+
+} // namespace Shadows
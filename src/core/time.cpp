@@ -3,9 +3,39 @@
 
 void Time::update_delta_time(entt::registry& registry)
 {
-    auto current_time = std::chrono::system_clock::now();
+    auto current_time = std::chrono::steady_clock::now();
 
     auto& delta_time = registry.ctx().emplace<Delta>();
-    delta_time.delta = current_time - delta_time.last_time;
+
+    // The first frame has no predecessor to measure against.
+    if (delta_time.last_time != std::chrono::steady_clock::time_point{}) {
+        delta_time.delta = current_time - delta_time.last_time;
+    }
     delta_time.last_time = current_time;
 }
+
+void Time::set_delta_time(entt::registry& registry, std::chrono::duration<double> delta)
+{
+    registry.ctx().emplace<Delta>().delta = delta;
+}
+
+auto Time::advance_fixed_step(entt::registry& registry) -> unsigned
+{
+    auto& fixed_step = registry.ctx().get<FixedStep>();
+    fixed_step.accumulator += registry.ctx().get<Delta>().delta;
+
+    auto steps = static_cast<std::uint64_t>(fixed_step.accumulator / fixed_step.step);
+    if (steps > fixed_step.max_steps) {
+        // Keeps the progress towards the next step
+        auto const dropped = steps - fixed_step.max_steps;
+        fixed_step.accumulator -= static_cast<double>(dropped) * fixed_step.step;
+        fixed_step.dropped_steps += dropped;
+        steps = fixed_step.max_steps;
+    }
+
+    fixed_step.accumulator -= static_cast<double>(steps) * fixed_step.step;
+    fixed_step.alpha = static_cast<float>(fixed_step.accumulator / fixed_step.step);
+    fixed_step.steps += steps;
+
+    return static_cast<unsigned>(steps);
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <entt/entt.hpp>
 
 namespace Time {
@@ -8,9 +9,34 @@ namespace Time {
 struct Delta
 {
     std::chrono::duration<double> delta;
-    std::chrono::time_point<std::chrono::system_clock> last_time;
+    std::chrono::steady_clock::time_point last_time;
+};
+
+// The simulation advances in steps of a fixed duration, independent of the frame rate. Every
+// frame adds its delta to the accumulator and takes as many steps as fit into it.
+struct FixedStep
+{
+    std::chrono::duration<double> step{1.0 / 60.0};
+
+    // A frame taking longer than this many steps drops the time beyond, so that the simulation
+    // slows down instead of taking ever more steps per frame.
+    unsigned max_steps = 4;
+
+    std::chrono::duration<double> accumulator{};
+
+    // Progress towards the next step in [0, 1), for interpolating between the last two steps.
+    float alpha{};
+
+    std::uint64_t steps{};
+    std::uint64_t dropped_steps{};
 };
 
 void update_delta_time(entt::registry& registry);
 
-} // namespace Time
\ No newline at end of file
+// Overrides the delta of the current frame, e.g. with the one of a replayed frame.
+void set_delta_time(entt::registry& registry, std::chrono::duration<double> delta);
+
+// Accumulates the delta of the frame and returns the number of fixed steps to take.
+auto advance_fixed_step(entt::registry& registry) -> unsigned;
+
+} // namespace Time
@@ -0,0 +1,307 @@
+#include "post_processing.h"
+#include "core/graphics/gl_state.h"
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace PostProcessing {
+
+namespace {
+
+constexpr std::string_view SHADER_DIRECTORY{"data/shaders"};
+
+auto constant(std::string_view name, float value) -> std::string
+{
+    return fmt::format("const float {} = {:.6f}f;\n", name, value);
+}
+
+// One pass before code generation: an optional leading neighborhood effect and the per-pixel
+// effects following it.
+struct PassEffects
+{
+    std::vector<Effect const*> effects;
+    bool tone_mapped;
+};
+
+auto generate(PassEffects const& pass, std::vector<EffectTexture>& textures) -> std::string
+{
+    std::string source = "#version 430 core\n\n"
+                         "layout(location = 0) out vec4 f_color;\n\n"
+                         "in vec2 v_tex_coords;\n\n";
+
+    source += fmt::format("layout(binding = {}) uniform sampler2D u_source;\n",
+                          Chain::SOURCE_TEXTURE_UNIT);
+
+    std::vector<std::string_view> defined;
+    for (auto const* effect : pass.effects) {
+        if (std::find(defined.cbegin(), defined.cend(), effect->name) != defined.cend()) {
+            continue;
+        }
+        defined.push_back(effect->name);
+
+        for (auto const& texture : effect->textures) {
+            auto binding = Chain::SOURCE_TEXTURE_UNIT + 1 + static_cast<GLuint>(textures.size());
+            source += fmt::format("layout(binding = {}) uniform {} {};\n",
+                                  binding,
+                                  texture.sampler_type,
+                                  texture.sampler);
+            textures.push_back(texture);
+        }
+    }
+
+    defined.clear();
+    for (auto const* effect : pass.effects) {
+        if (std::find(defined.cbegin(), defined.cend(), effect->name) != defined.cend()) {
+            continue;
+        }
+        defined.push_back(effect->name);
+
+        source += "\n" + effect->source;
+    }
+
+    source += "\nvoid main()\n{\n";
+
+    auto per_pixel = pass.effects.cbegin();
+    if (!pass.effects.empty() && pass.effects.front()->kind == Kind::Neighborhood) {
+        source += fmt::format("    vec3 color = {}(u_source, v_tex_coords);\n",
+                              pass.effects.front()->name);
+        ++per_pixel;
+    } else {
+        source += "    vec3 color = texture(u_source, v_tex_coords).rgb;\n";
+    }
+
+    for (; per_pixel != pass.effects.cend(); ++per_pixel) {
+        source += fmt::format("    color = {}(color, v_tex_coords);\n", (*per_pixel)->name);
+    }
+
+    source += "    f_color = vec4(color, 1.0f);\n}\n";
+
+    return source;
+}
+
+} // namespace
+
+auto tone_map(float exposure) -> Effect
+{
+    return Effect{.name = "toneMap",
+                  .kind = Kind::PerPixel,
+                  .source = constant("TONE_MAP_EXPOSURE", exposure) + R"(
+vec3 toneMap(vec3 color, vec2 uv)
+{
+    // Exposure tone mapping
+    return vec3(1.0f) - exp(-color * TONE_MAP_EXPOSURE);
+}
+)",
+                  .tone_maps = true};
+}
+
+auto gamma_correction(float gamma) -> Effect
+{
+    return Effect{.name = "gammaCorrection",
+                  .kind = Kind::PerPixel,
+                  .source = constant("GAMMA", gamma) + R"(
+vec3 gammaCorrection(vec3 color, vec2 uv)
+{
+    return pow(color, vec3(1.0f / GAMMA));
+}
+)"};
+}
+
+auto color_grading(GLuint lookup_table, unsigned size) -> Effect
+{
+    return Effect{.name = "colorGrading",
+                  .kind = Kind::PerPixel,
+                  .source = constant("COLOR_GRADING_LUT_SIZE", static_cast<float>(size)) + R"(
+vec3 colorGrading(vec3 color, vec2 uv)
+{
+    // Map [0, 1] onto the centers of the outer texels, so that the table is interpolated
+    // between its entries.
+    float scale = (COLOR_GRADING_LUT_SIZE - 1.0f) / COLOR_GRADING_LUT_SIZE;
+    float offset = 0.5f / COLOR_GRADING_LUT_SIZE;
+    return texture(u_colorGradingLut, clamp(color, 0.0f, 1.0f) * scale + offset).rgb;
+}
+)",
+                  .textures = {EffectTexture{.sampler = "u_colorGradingLut",
+                                             .sampler_type = "sampler3D",
+                                             .target = GL_TEXTURE_3D,
+                                             .texture = lookup_table}}};
+}
+
+auto vignette(float intensity, float radius) -> Effect
+{
+    return Effect{.name = "vignette",
+                  .kind = Kind::PerPixel,
+                  .source = constant("VIGNETTE_INTENSITY", intensity) +
+                            constant("VIGNETTE_RADIUS", radius) + R"(
+vec3 vignette(vec3 color, vec2 uv)
+{
+    // Distance to the center, 1 in the corners
+    float distance = length(uv - 0.5f) * 1.41421356f;
+    return color * (1.0f - VIGNETTE_INTENSITY * smoothstep(VIGNETTE_RADIUS, 1.0f, distance));
+}
+)"};
+}
+
+auto dithering() -> Effect
+{
+    return Effect{.name = "dithering", .kind = Kind::PerPixel, .source = R"(
+vec3 dithering(vec3 color, vec2 uv)
+{
+    // Interleaved gradient noise
+    float noise = fract(52.9829189f * fract(dot(gl_FragCoord.xy, vec2(0.06711056f, 0.00583715f))));
+    return color + (noise - 0.5f) / 255.0f;
+}
+)"};
+}
+
+auto fxaa() -> Effect
+{
+    return Effect{.name = "fxaa", .kind = Kind::Neighborhood, .source = R"(
+const float FXAA_SPAN_MAX = 8.0f;
+const float FXAA_REDUCE_MUL = 1.0f / 8.0f;
+const float FXAA_REDUCE_MIN = 1.0f / 128.0f;
+
+float fxaaLuma(vec3 color)
+{
+    return dot(color, vec3(0.299f, 0.587f, 0.114f));
+}
+
+vec3 fxaa(sampler2D source, vec2 uv)
+{
+    vec2 texel = 1.0f / vec2(textureSize(source, 0));
+
+    float lumaNW = fxaaLuma(texture(source, uv + vec2(-1.0f, -1.0f) * texel).rgb);
+    float lumaNE = fxaaLuma(texture(source, uv + vec2(1.0f, -1.0f) * texel).rgb);
+    float lumaSW = fxaaLuma(texture(source, uv + vec2(-1.0f, 1.0f) * texel).rgb);
+    float lumaSE = fxaaLuma(texture(source, uv + vec2(1.0f, 1.0f) * texel).rgb);
+    vec3 colorM = texture(source, uv).rgb;
+    float lumaM = fxaaLuma(colorM);
+
+    float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+    float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+    // Blur along the edge, which is perpendicular to the luma gradient
+    vec2 direction = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)),
+                          (lumaNW + lumaSW) - (lumaNE + lumaSE));
+
+    float directionReduce =
+        max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25f * FXAA_REDUCE_MUL, FXAA_REDUCE_MIN);
+    float inverseDirectionMin = 1.0f / (min(abs(direction.x), abs(direction.y)) + directionReduce);
+    direction = clamp(direction * inverseDirectionMin, -FXAA_SPAN_MAX, FXAA_SPAN_MAX) * texel;
+
+    vec3 colorA = 0.5f * (texture(source, uv + direction * (1.0f / 3.0f - 0.5f)).rgb +
+                          texture(source, uv + direction * (2.0f / 3.0f - 0.5f)).rgb);
+    vec3 colorB = colorA * 0.5f + 0.25f * (texture(source, uv - direction * 0.5f).rgb +
+                                           texture(source, uv + direction * 0.5f).rgb);
+
+    // The wider blur crossed another edge if it left the local luma range
+    float lumaB = fxaaLuma(colorB);
+    return (lumaB < lumaMin || lumaB > lumaMax) ? colorA : colorB;
+}
+)"};
+}
+
+auto bloom(float threshold, float intensity) -> Effect
+{
+    return Effect{.name = "bloom",
+                  .kind = Kind::Neighborhood,
+                  .source = constant("BLOOM_THRESHOLD", threshold) +
+                            constant("BLOOM_INTENSITY", intensity) + R"(
+const int BLOOM_TAPS = 2;
+const float BLOOM_SPACING = 3.0f;
+
+vec3 bloom(sampler2D source, vec2 uv)
+{
+    vec2 texel = BLOOM_SPACING / vec2(textureSize(source, 0));
+
+    // Sparse gaussian over the bright parts; the bilinear filter blurs between the taps.
+    vec3 glow = vec3(0.0f);
+    float weightSum = 0.0f;
+    for (int x = -BLOOM_TAPS; x <= BLOOM_TAPS; ++x) {
+        for (int y = -BLOOM_TAPS; y <= BLOOM_TAPS; ++y) {
+            float weight = exp(-float(x * x + y * y) / float(BLOOM_TAPS * BLOOM_TAPS));
+            vec3 color = texture(source, uv + vec2(x, y) * texel).rgb;
+            glow += max(color - BLOOM_THRESHOLD, 0.0f) * weight;
+            weightSum += weight;
+        }
+    }
+
+    return texture(source, uv).rgb + glow / weightSum * BLOOM_INTENSITY;
+}
+)"};
+}
+
+Chain::Chain(std::vector<Effect> const& effects)
+{
+    std::vector<PassEffects> pass_effects(1);
+
+    bool tone_mapped = false;
+    for (auto const& effect : effects) {
+        if (effect.kind == Kind::Neighborhood && !pass_effects.back().effects.empty()) {
+            pass_effects.push_back({});
+        }
+
+        tone_mapped = tone_mapped || effect.tone_maps;
+
+        pass_effects.back().effects.push_back(&effect);
+        pass_effects.back().tone_mapped = tone_mapped;
+    }
+
+    for (auto const& pass : pass_effects) {
+        std::vector<EffectTexture> textures;
+        std::string source = generate(pass, textures);
+
+        passes.push_back(Pass{
+            .shader = Shader::from_fragment_source("post_processing", source, SHADER_DIRECTORY),
+            .textures = std::move(textures),
+            .output_format = pass.tone_mapped ? GLenum{GL_RGBA8} : GLenum{GL_RGBA16F}});
+    }
+
+    spdlog::debug(
+        "Compiled {} post-processing effects into {} passes", effects.size(), passes.size());
+}
+
+auto Chain::add_passes(RenderGraph& graph,
+                       RenderGraph::TextureHandle input,
+                       glm::u32vec2 dimensions,
+                       glm::u32vec2 output_dimensions) -> RenderGraph::TextureHandle
+{
+    for (std::size_t i = 0; i < passes.size(); ++i) {
+        bool const last = i + 1 == passes.size();
+        auto& pass = passes[i];
+
+        graph.add_pass(
+            "post_processing_" + std::to_string(i),
+            [&](RenderGraph::PassBuilder& builder) {
+                pass.input = input;
+                builder.read(input);
+
+                pass.output = builder.create(
+                    last ? TextureDescription{.dimensions = output_dimensions,
+                                              .internal_format = GL_RGBA8}
+                         : TextureDescription{.dimensions = dimensions,
+                                              .internal_format = pass.output_format});
+                input = pass.output;
+            },
+            [&pass](RenderGraph::PassContext const& context) {
+                GLenum polygon_mode = GlState::polygon_mode();
+                GlState::polygon_mode(GL_FILL);
+
+                pass.shader.bind();
+                GlState::bind_texture(SOURCE_TEXTURE_UNIT, context.texture(pass.input));
+                for (GLuint unit = 0; unit < pass.textures.size(); ++unit) {
+                    auto const& texture = pass.textures[unit];
+                    GlState::bind_texture(
+                        SOURCE_TEXTURE_UNIT + 1 + unit, texture.texture, texture.target);
+                }
+
+                context.draw_fullscreen_triangle();
+
+                GlState::polygon_mode(polygon_mode);
+            });
+    }
+
+    return input;
+}
+
+} // namespace PostProcessing
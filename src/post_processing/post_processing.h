@@ -1,2 +1,101 @@
 #pragma once
 
+#include "core/render_graph.h"
+#include "core/shader.h"
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+namespace PostProcessing {
+
+enum class Kind
+{
+    // Maps the color of a pixel to a new one. Fused into the pass of the preceding effect.
+    PerPixel,
+    // Samples the neighborhood of a pixel, so its input has to be a texture. Starts a new pass.
+    Neighborhood,
+};
+
+// A texture an effect samples besides its input, e.g. a color grading lookup table. Binding
+// points are assigned when the chain is compiled.
+struct EffectTexture
+{
+    std::string sampler;      // Name of the sampler in the GLSL source
+    std::string sampler_type; // e.g. "sampler3D"
+    GLenum target;
+    GLuint texture;
+};
+
+struct Effect
+{
+    // Name of the GLSL function applying the effect. Effects with the same name in one pass are
+    // expected to share their source.
+    std::string name;
+    Kind kind;
+
+    // Definition of the function and its helpers. Per-pixel effects are called as
+    // vec3 name(vec3 color, vec2 uv), neighborhood effects as vec3 name(sampler2D source, vec2 uv).
+    std::string source;
+
+    std::vector<EffectTexture> textures{};
+
+    // The output is in [0, 1], so later intermediate targets only need 8 bits per channel.
+    bool tone_maps = false;
+};
+
+auto tone_map(float exposure) -> Effect;
+auto gamma_correction(float gamma) -> Effect;
+
+// Maps colors through a 3D lookup table of size^3 texels.
+auto color_grading(GLuint lookup_table, unsigned size) -> Effect;
+
+auto vignette(float intensity, float radius) -> Effect;
+
+// Adds noise below one step of an 8 bit target, which hides banding in gradients.
+auto dithering() -> Effect;
+
+auto fxaa() -> Effect;
+
+// Single-pass bloom, blurring the parts brighter than the threshold with a sparse kernel. Its
+// radius is limited to a few texels, a wide glow would need a downsampled blur chain.
+auto bloom(float threshold, float intensity) -> Effect;
+
+// A post-processing stack compiled into the smallest number of full-screen passes. Every
+// neighborhood effect except a leading one starts a new pass, all per-pixel effects are fused
+// into the pass before them. Each pass is one generated fragment shader.
+class Chain
+{
+public:
+    static constexpr GLuint SOURCE_TEXTURE_UNIT = 0;
+
+    explicit Chain(std::vector<Effect> const& effects);
+
+    // Adds the passes reading the input to the graph. Intermediate targets have the dimensions of
+    // the input, the last pass scales the image to the output dimensions and returns it.
+    auto add_passes(RenderGraph& graph,
+                    RenderGraph::TextureHandle input,
+                    glm::u32vec2 dimensions,
+                    glm::u32vec2 output_dimensions) -> RenderGraph::TextureHandle;
+
+    [[nodiscard]] auto pass_count() const -> std::size_t { return passes.size(); }
+
+private:
+    struct Pass
+    {
+        Shader shader;
+        std::vector<EffectTexture> textures;
+
+        // Format of the intermediate target, the output of the last pass is always 8 bit.
+        GLenum output_format;
+
+        // Handles of the frame currently being built
+        RenderGraph::TextureHandle input{};
+        RenderGraph::TextureHandle output{};
+    };
+
+    std::vector<Pass> passes;
+};
+
+} // namespace PostProcessing
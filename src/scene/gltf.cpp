@@ -2,8 +2,10 @@
 #include "components/name.h"
 #include "components/relationship.h"
 #include "core/camera.h"
+#include "core/graphics/geometry_pool.h"
 
 #include <spdlog/spdlog.h>
+#include <unordered_map>
 
 auto Gltf::spawn_scene(std::size_t index,
                        entt::registry& registry,
@@ -112,19 +114,34 @@ auto Gltf::spawn_default_scene(entt::registry& registry,
 
     auto scene = spawn_scene(document.scene, registry, node_cache);
 
-    // Convert meshes
+    // Convert meshes, every mesh resource is only uploaded once.
+    auto& geometry_uploader = registry.ctx().get<GeometryUploader>();
+    std::unordered_map<Mesh const*, GpuMesh> gpu_meshes;
+
     auto mesh_view = registry.view<entt::resource<Mesh>>();
     for (auto [entity, mesh] : mesh_view.each()) {
-        registry.emplace<GpuMesh>(entity, GpuMesh(mesh));
+        auto [gpu_mesh, inserted] = gpu_meshes.try_emplace(&*mesh);
+        if (inserted) {
+            gpu_mesh->second = geometry_uploader.upload(*mesh);
+        }
+
+        registry.emplace<GpuMesh>(entity, gpu_mesh->second);
 
         // Remove Mesh resource as it is no longer needed.
         registry.erase<entt::resource<Mesh>>(entity);
     }
 
-    // Convert materials
+    // Convert materials, entities with the same material share its textures.
+    std::unordered_map<Material const*, GpuMaterial> gpu_materials;
+
     auto material_view = registry.view<entt::resource<Material>>();
     for (auto [entity, material] : material_view.each()) {
-        registry.emplace<GpuMaterial>(entity, GpuMaterial(material));
+        auto gpu_material = gpu_materials.find(&*material);
+        if (gpu_material == gpu_materials.end()) {
+            gpu_material = gpu_materials.emplace(&*material, GpuMaterial(*material)).first;
+        }
+
+        registry.emplace<GpuMaterial>(entity, gpu_material->second);
 
         // Remove Material resource as it is no longer needed.
         registry.erase<entt::resource<Material>>(entity);
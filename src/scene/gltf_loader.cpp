@@ -2,8 +2,10 @@
 #include "components/name.h"
 #include "components/relationship.h"
 #include "core/camera.h"
+#include "core/jobs.h"
 #include "entt/entity/fwd.hpp"
 #include "scene.h"
+#include "util/profiler.h"
 
 #include <iterator>
 #include <spdlog/spdlog.h>
@@ -23,7 +25,7 @@ static auto create_vertex_attribute_data(std::span<uint8_t const> vertex_attribu
     -> VertexAttributeData
 {
     T attribute_data;
-    attribute_data.resize(vertex_attribute_data.size_bytes());
+    attribute_data.resize(vertex_attribute_data.size_bytes() / sizeof(typename T::value_type));
 
     std::memcpy(
         attribute_data.data(), vertex_attribute_data.data(), vertex_attribute_data.size_bytes());
@@ -35,39 +37,46 @@ template <typename T>
 static auto create_indices(std::span<uint8_t const> gltf_index_data) -> Indices
 {
     T index_data;
-    index_data.resize(gltf_index_data.size_bytes());
+    index_data.resize(gltf_index_data.size_bytes() / sizeof(typename T::value_type));
 
     std::memcpy(index_data.data(), gltf_index_data.data(), gltf_index_data.size_bytes());
 
     return Indices{.values = std::move(index_data)};
 }
 
-static auto load_texture(fx::gltf::Texture const& texture,
+// Name of an image in the image cache. Images in files are shared between documents.
+static auto image_name(std::size_t image_index,
+                       fx::gltf::Document const& gltf,
+                       std::filesystem::path const& document_path) -> std::string
+{
+    auto const& gltf_image = gltf.images.at(image_index);
+
+    if (gltf_image.uri.empty()) {
+        return document_path.string() + ".image." + std::to_string(image_index);
+    }
+
+    return (document_path.parent_path() / gltf_image.uri).string();
+}
+
+static auto decode_image(std::size_t image_index,
                          fx::gltf::Document const& gltf,
-                         std::filesystem::path const& document_path,
-                         Image::ColorFormat colorFormat,
-                         entt::resource_cache<Image>& image_cache) -> entt::resource<Image>
+                         std::filesystem::path const& document_path) -> Image
 {
-    auto const& gltf_image = gltf.images.at(texture.source);
-    auto const base_directory = document_path.parent_path();
+    FEVER_PROFILE_ZONE("decode_image");
 
+    auto const& gltf_image = gltf.images.at(image_index);
+
+    // The color format is set once the usage of the image is known.
     if (gltf_image.uri.empty()) {
         auto const& image_buffer_view = gltf.bufferViews.at(gltf_image.bufferView);
         auto const& image_buffer = gltf.buffers.at(image_buffer_view.buffer);
 
-        std::string const image_name =
-            document_path.string() + ".image." + std::to_string(texture.source);
-        entt::hashed_string const image_hash(image_name.c_str());
-
-        return image_cache
-            .load(image_hash,
-                  std::span{image_buffer.data}.subspan(image_buffer_view.byteOffset,
-                                                       image_buffer_view.byteLength),
-                  colorFormat)
-            .first->second;
+        return {std::span{image_buffer.data}.subspan(image_buffer_view.byteOffset,
+                                                     image_buffer_view.byteLength),
+                Image::ColorFormat::RGB};
     }
 
-    auto const image_path = base_directory / gltf_image.uri;
+    auto const image_path = document_path.parent_path() / gltf_image.uri;
     std::size_t const image_size = std::filesystem::file_size(image_path);
     auto image_ifstream = std::ifstream(image_path, std::ios::binary);
 
@@ -78,34 +87,95 @@ static auto load_texture(fx::gltf::Texture const& texture,
               std::istreambuf_iterator<char>(),
               std::back_inserter(image_data));
 
-    entt::hashed_string const image_hash(image_path.string().c_str());
+    return {image_data, Image::ColorFormat::RGB};
+}
 
-    return image_cache.load(image_hash, image_data, colorFormat).first->second;
+// Decodes the images materials refer to and which are not cached yet. Decoding dominates
+// loading, so all images are decoded in parallel up front.
+static auto decode_images(fx::gltf::Document const& gltf,
+                          std::filesystem::path const& document_path,
+                          entt::resource_cache<Image> const& image_cache)
+    -> std::vector<std::optional<Image>>
+{
+    std::vector<bool> used(gltf.images.size());
+    for (auto const& material : gltf.materials) {
+        for (auto texture_id : {material.pbrMetallicRoughness.baseColorTexture.index,
+                                material.normalTexture.index}) {
+            if (texture_id != -1) {
+                used.at(gltf.textures.at(texture_id).source) = true;
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < used.size(); ++i) {
+        entt::hashed_string const image_hash(image_name(i, gltf, document_path).c_str());
+        used[i] = used[i] && !image_cache.contains(image_hash);
+    }
+
+    std::vector<std::optional<Image>> images(gltf.images.size());
+    Jobs::parallel_for(0, images.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            if (used[i]) {
+                images[i].emplace(decode_image(i, gltf, document_path));
+            }
+        }
+    });
+
+    return images;
+}
+
+static auto load_texture(fx::gltf::Texture const& texture,
+                         fx::gltf::Document const& gltf,
+                         std::filesystem::path const& document_path,
+                         Image::ColorFormat colorFormat,
+                         std::vector<std::optional<Image>>& images,
+                         entt::resource_cache<Image>& image_cache) -> entt::resource<Image>
+{
+    FEVER_PROFILE_ZONE("load_texture");
+
+    auto const image_index = static_cast<std::size_t>(texture.source);
+    entt::hashed_string const image_hash(image_name(image_index, gltf, document_path).c_str());
+
+    // Textures sharing an image take it from the cache.
+    auto& image = images.at(image_index);
+    if (image_cache.contains(image_hash) || !image.has_value()) {
+        return image_cache[image_hash];
+    }
+
+    image->colorFormat = colorFormat;
+    return image_cache.load(image_hash, std::move(image.value())).first->second;
 }
 
 static auto load_material(fx::gltf::Material const& material,
                           fx::gltf::Document const& gltf,
                           std::filesystem::path const& document_path,
+                          std::vector<std::optional<Image>>& images,
                           entt::resource_cache<Material>& material_cache,
                           entt::resource_cache<Image>& image_cache,
                           entt::resource_cache<Shader, ShaderLoader>& shader_cache)
     -> entt::resource<Material>
 {
+    FEVER_PROFILE_ZONE("load_material");
+
     auto base_color_texture_id = material.pbrMetallicRoughness.baseColorTexture.index;
     auto normal_texture_id = material.normalTexture.index;
 
     std::optional<entt::resource<Image>> base_color_image;
     if (base_color_texture_id != -1) {
         auto const& base_color_texture = gltf.textures.at(base_color_texture_id);
-        base_color_image = load_texture(
-            base_color_texture, gltf, document_path, Image::ColorFormat::SRGB, image_cache);
+        base_color_image = load_texture(base_color_texture,
+                                        gltf,
+                                        document_path,
+                                        Image::ColorFormat::SRGB,
+                                        images,
+                                        image_cache);
     }
 
     std::optional<entt::resource<Image>> normal_map_image;
     if (normal_texture_id != -1) {
         auto const& normal_texture = gltf.textures.at(normal_texture_id);
-        normal_map_image =
-            load_texture(normal_texture, gltf, document_path, Image::ColorFormat::RGB, image_cache);
+        normal_map_image = load_texture(
+            normal_texture, gltf, document_path, Image::ColorFormat::RGB, images, image_cache);
     }
 
     entt::hashed_string shader_hash(Material::SHADER_NAME.data());
@@ -197,6 +267,8 @@ auto load_gltf_primitive(fx::gltf::Primitive const& gltf_primitive,
                          entt::resource_cache<Material>& material_cache,
                          entt::resource_cache<Mesh>& mesh_cache) -> GltfPrimitive
 {
+    FEVER_PROFILE_ZONE("load_primitive");
+
     // Load attributes
     auto tangent_it =
         std::find_if(gltf_primitive.attributes.cbegin(),
@@ -260,10 +332,14 @@ auto load_gltf_primitive(fx::gltf::Primitive const& gltf_primitive,
 
 auto GltfLoader::operator()(std::filesystem::path const& document_path) -> result_type
 {
+    FEVER_PROFILE_ZONE("load_gltf");
+
     fx::gltf::ReadQuotas const read_quotas{.MaxFileSize = MAX_SIZE,
                                            .MaxBufferByteLength = MAX_SIZE};
 
     fx::gltf::Document gltf = [&]() {
+        FEVER_PROFILE_ZONE("parse_gltf");
+
         if (document_path.extension() == ".gltf") {
             return fx::gltf::LoadFromText(document_path, read_quotas);
         }
@@ -275,10 +351,12 @@ auto GltfLoader::operator()(std::filesystem::path const& document_path) -> resul
     auto const base_directory = document_path.parent_path();
 
     // Load materials
+    auto images = decode_images(gltf, document_path, image_cache);
+
     std::vector<entt::resource<Material>> materials;
     for (auto const& gltf_material : gltf.materials) {
         entt::resource<Material> material = load_material(
-            gltf_material, gltf, document_path, material_cache, image_cache, shader_cache);
+            gltf_material, gltf, document_path, images, material_cache, image_cache, shader_cache);
         materials.push_back(material);
     }
 
@@ -316,6 +394,8 @@ auto GltfLoader::operator()(std::filesystem::path const& document_path) -> resul
     }
 
     // Load nodes
+    FEVER_PROFILE_ZONE("load_nodes");
+
     std::unordered_map<std::size_t, entt::resource<GltfNode>> nodes_map;
     nodes_map.reserve(gltf.nodes.size());
     for (std::size_t i = 0; i < gltf.nodes.size(); ++i) {
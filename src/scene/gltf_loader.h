@@ -8,6 +8,14 @@
 
 static constexpr auto MAX_SIZE = 512 * 1024 * 1024;
 
+// Loads the attributes and indices of a primitive into the mesh cache, keyed by the identifier.
+// The material has to be in the material cache already.
+auto load_gltf_primitive(fx::gltf::Primitive const& gltf_primitive,
+                         fx::gltf::Document const& gltf,
+                         std::string_view primitive_identifier,
+                         entt::resource_cache<Material>& material_cache,
+                         entt::resource_cache<Mesh>& mesh_cache) -> GltfPrimitive;
+
 struct GltfLoader
 {
     using result_type = std::shared_ptr<Gltf>;
@@ -0,0 +1,303 @@
+#include "stress_scene.h"
+#include "components/relationship.h"
+#include "components/transform.h"
+#include "core/command_buffer.h"
+#include "core/graphics/geometry_pool.h"
+#include "core/jobs.h"
+#include "core/light.h"
+#include "core/shadows.h"
+#include "core/time.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <vector>
+
+namespace StressScene {
+
+namespace {
+
+constexpr float SPACING = 3.0F;
+
+// Hierarchies recorded per job
+constexpr std::size_t CHAINS_PER_JOB = 1024;
+
+// Offset and scale of a child relative to its parent
+constexpr glm::vec3 CHILD_OFFSET{0.0F, 1.5F, 0.0F};
+constexpr float CHILD_SCALE = 0.8F;
+
+struct Locations
+{
+    std::size_t position = 0;
+    std::size_t uv = 1;
+    std::size_t normal = 2;
+    std::size_t tangent = 3;
+};
+
+constexpr Locations ATTRIBUTE_LOCATION;
+
+// Sphere of radius 0.5. Meshes differ in their tessellation, so that they are distinct draws
+// of different cost.
+auto sphere(unsigned rings) -> Mesh
+{
+    unsigned const segments = rings * 2;
+
+    VertexAttributeData::Vec3 positions;
+    VertexAttributeData::Vec2 uvs;
+    VertexAttributeData::Vec3 normals;
+    VertexAttributeData::Vec4 tangents;
+
+    for (unsigned ring = 0; ring <= rings; ++ring) {
+        float const v = static_cast<float>(ring) / static_cast<float>(rings);
+        float const theta = v * std::numbers::pi_v<float>;
+
+        for (unsigned segment = 0; segment <= segments; ++segment) {
+            float const u = static_cast<float>(segment) / static_cast<float>(segments);
+            float const phi = u * 2.0F * std::numbers::pi_v<float>;
+
+            glm::vec3 const normal{
+                std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)};
+
+            positions.push_back({normal.x * 0.5F, normal.y * 0.5F, normal.z * 0.5F});
+            uvs.push_back({u, v});
+            normals.push_back({normal.x, normal.y, normal.z});
+            tangents.push_back({-std::sin(phi), 0.0F, std::cos(phi), 1.0F});
+        }
+    }
+
+    Indices::UnsignedInt indices;
+    for (unsigned ring = 0; ring < rings; ++ring) {
+        for (unsigned segment = 0; segment < segments; ++segment) {
+            std::uint32_t const current = ring * (segments + 1) + segment;
+            std::uint32_t const below = current + segments + 1;
+
+            indices.insert(indices.end(), {current, current + 1, below});
+            indices.insert(indices.end(), {current + 1, below + 1, below});
+        }
+    }
+
+    Mesh mesh;
+    mesh.attributes.emplace(ATTRIBUTE_LOCATION.position,
+                            VertexAttributeData{std::move(positions)});
+    mesh.attributes.emplace(ATTRIBUTE_LOCATION.uv, VertexAttributeData{std::move(uvs)});
+    mesh.attributes.emplace(ATTRIBUTE_LOCATION.normal, VertexAttributeData{std::move(normals)});
+    mesh.attributes.emplace(ATTRIBUTE_LOCATION.tangent, VertexAttributeData{std::move(tangents)});
+    mesh.indices = Indices{std::move(indices)};
+
+    return mesh;
+}
+
+auto solid_image(glm::vec3 color, Image::ColorFormat color_format) -> Image
+{
+    auto channel = [](float value) { return static_cast<std::uint8_t>(value * 255.0F + 0.5F); };
+
+    return Image(Image::Extent{.width = 1, .height = 1},
+                 {channel(color.x), channel(color.y), channel(color.z)},
+                 Image::DataFormat::RGB8Uint,
+                 color_format);
+}
+
+// Fully saturated color of the given hue in [0, 1]
+auto hue(float value) -> glm::vec3
+{
+    auto channel = [value](float offset) {
+        float const h = std::fmod(value * 6.0F + offset, 6.0F);
+        return std::clamp(std::abs(h - 3.0F) - 1.0F, 0.0F, 1.0F);
+    };
+
+    return {channel(0.0F), channel(4.0F), channel(2.0F)};
+}
+
+} // namespace
+
+void spawn(entt::registry& registry, Caches const& caches, Parameters const& parameters)
+{
+    std::mt19937 random(parameters.seed);
+    std::uniform_real_distribution<float> unit(0.0F, 1.0F);
+
+    // Meshes
+    auto& geometry_uploader = registry.ctx().get<GeometryUploader>();
+
+    std::vector<GpuMesh> meshes;
+    for (std::size_t i = 0; i < std::max<std::size_t>(parameters.unique_meshes, 1); ++i) {
+        entt::hashed_string const hash(("stress.mesh." + std::to_string(i)).c_str());
+        entt::resource<Mesh> mesh =
+            caches.mesh_cache.load(hash, sphere(4 + static_cast<unsigned>(i % 29))).first->second;
+
+        meshes.push_back(geometry_uploader.upload(*mesh));
+    }
+
+    // Materials share a flat normal map and differ in their base color.
+    entt::resource<Image> normal_map =
+        caches.image_cache
+            .load(entt::hashed_string("stress.normal_map"),
+                  solid_image({0.5F, 0.5F, 1.0F}, Image::ColorFormat::RGB))
+            .first->second;
+
+    entt::hashed_string const shader_hash(Material::SHADER_NAME.data());
+    entt::resource<Shader> shader =
+        caches.shader_cache.load(shader_hash, Material::SHADER_NAME).first->second;
+
+    std::vector<GpuMaterial> materials;
+    for (std::size_t i = 0; i < std::max<std::size_t>(parameters.materials, 1); ++i) {
+        glm::vec3 const color = hue(unit(random));
+
+        std::string const name = "stress.material." + std::to_string(i);
+        entt::resource<Image> base_color =
+            caches.image_cache
+                .load(entt::hashed_string((name + ".base_color").c_str()),
+                      solid_image(color, Image::ColorFormat::SRGB))
+                .first->second;
+
+        entt::resource<Material> material =
+            caches.material_cache
+                .load(entt::hashed_string(name.c_str()),
+                      Material{.base_color_texture = base_color,
+                               .normal_map_texture = normal_map,
+                               .shader = shader})
+                .first->second;
+
+        materials.emplace_back(*material);
+    }
+
+    // Entities, as chains of hierarchy_depth + 1 entities on a cubic grid. They are reserved
+    // here so that the jobs can refer to parents and children, which record the components.
+    std::size_t const chain_length = parameters.hierarchy_depth + 1;
+    std::size_t const chains = (parameters.entities + chain_length - 1) / chain_length;
+    auto const grid_size =
+        static_cast<std::size_t>(std::ceil(std::cbrt(static_cast<double>(chains))));
+
+    std::vector<entt::entity> entities(parameters.entities);
+    registry.create(entities.begin(), entities.end());
+
+    auto& queue = registry.ctx().get<CommandQueue>();
+    std::size_t const jobs = (chains + CHAINS_PER_JOB - 1) / CHAINS_PER_JOB;
+
+    std::vector<CommandQueue::Ticket> tickets;
+    for (std::size_t job = 0; job < jobs; ++job) {
+        tickets.push_back(queue.reserve());
+    }
+
+    std::vector<std::size_t> moving(jobs);
+
+    Jobs::parallel_for(0, jobs, 1, [&](std::size_t jobs_begin, std::size_t jobs_end) {
+        for (std::size_t job = jobs_begin; job < jobs_end; ++job) {
+            // Seeded per job, so that the scene does not depend on the number of threads.
+            std::seed_seq seed{parameters.seed, static_cast<std::uint32_t>(job)};
+            std::mt19937 job_random(seed);
+            std::uniform_real_distribution<float> job_unit(0.0F, 1.0F);
+            std::uniform_int_distribution<std::size_t> mesh_index(0, meshes.size() - 1);
+            std::uniform_int_distribution<std::size_t> material_index(0, materials.size() - 1);
+
+            std::size_t const begin = job * CHAINS_PER_JOB * chain_length;
+            std::size_t const end =
+                std::min((job + 1) * CHAINS_PER_JOB * chain_length, parameters.entities);
+
+            // Recorded type by type, so that every type is inserted in bulk.
+            CommandBuffer commands;
+            for (std::size_t i = begin; i < end; ++i) {
+                Transform transform{.translation = CHILD_OFFSET, .scale = glm::vec3(CHILD_SCALE)};
+                if (i % chain_length == 0) {
+                    std::size_t const chain = i / chain_length;
+                    glm::vec3 cell{chain % grid_size,
+                                   chain / grid_size % grid_size,
+                                   chain / (grid_size * grid_size)};
+                    transform = Transform{.translation = cell * SPACING};
+                }
+                commands.emplace(entities[i], transform);
+            }
+            for (std::size_t i = begin; i < end; ++i) {
+                commands.emplace(entities[i], GlobalTransform{});
+            }
+            for (std::size_t i = begin; i < end; ++i) {
+                commands.emplace(entities[i], meshes[mesh_index(job_random)]);
+            }
+            for (std::size_t i = begin; i < end; ++i) {
+                commands.emplace(entities[i], materials[material_index(job_random)]);
+            }
+            for (std::size_t i = begin; i < end; ++i) {
+                if (i % chain_length != 0) {
+                    commands.emplace(entities[i], Parent{.parent = entities[i - 1]});
+                }
+            }
+            for (std::size_t i = begin; i < end; ++i) {
+                if ((i + 1) % chain_length != 0 && i + 1 < end) {
+                    commands.emplace(entities[i], Children{.children = {entities[i + 1]}});
+                }
+            }
+
+            // Children of a moving entity move as well, which invalidates cached shadows.
+            std::vector<entt::entity> dynamic;
+            bool parent_moves = false;
+            for (std::size_t i = begin; i < end; ++i) {
+                if (i % chain_length == 0) {
+                    parent_moves = false;
+                }
+
+                bool const moves = job_unit(job_random) < parameters.moving_fraction;
+                if (moves) {
+                    glm::vec3 const direction{
+                        job_unit(job_random), job_unit(job_random), job_unit(job_random)};
+                    glm::vec3 axis = glm::normalize(direction + 0.1F);
+                    commands.emplace(entities[i],
+                                     Mover{.axis = axis, .speed = 0.5F + job_unit(job_random)});
+                    ++moving[job];
+                }
+
+                parent_moves = parent_moves || moves;
+                if (parent_moves) {
+                    dynamic.push_back(entities[i]);
+                }
+            }
+            for (auto entity : dynamic) {
+                commands.emplace(entity, DynamicShadowCaster{});
+            }
+            for (auto entity : dynamic) {
+                commands.emplace(entity, Interpolated{});
+            }
+
+            queue.submit(tickets[job], std::move(commands));
+        }
+    });
+
+    // Point lights spread over the grid
+    CommandBuffer lights;
+    float const extent = static_cast<float>(grid_size) * SPACING;
+    for (std::size_t i = 0; i < parameters.point_lights; ++i) {
+        auto light = lights.create();
+
+        glm::vec3 position{
+            unit(random) * extent, unit(random) * extent + 1.0F, unit(random) * extent};
+        glm::vec3 color = hue(unit(random));
+
+        lights.emplace(light, Transform{.translation = position});
+        lights.emplace(light, GlobalTransform{});
+        lights.emplace(light,
+                       PointLight{.color = Color{.r = color.x, .g = color.y, .b = color.z},
+                                  .intensity = PointLight::DEFAULT_INTENSITY});
+    }
+    queue.submit(queue.reserve(), std::move(lights));
+
+    spdlog::info("Stress scene: {} entities ({} moving), {} meshes, {} materials, {} lights",
+                 parameters.entities,
+                 std::accumulate(moving.begin(), moving.end(), std::size_t{0}),
+                 meshes.size(),
+                 materials.size(),
+                 parameters.point_lights);
+}
+
+void animate(entt::registry& registry)
+{
+    auto const delta = static_cast<float>(registry.ctx().get<Time::FixedStep>().step.count());
+
+    for (auto [entity, mover, transform] : registry.view<Mover const, Transform>().each()) {
+        transform.orientation =
+            glm::angleAxis(mover.speed * delta, mover.axis) * transform.orientation;
+    }
+}
+
+} // namespace StressScene
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "core/graphics/image.h"
+#include "core/graphics/material.h"
+#include "core/graphics/mesh.h"
+#include "core/shader.h"
+
+#include <cstdint>
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+
+// Generated scenes to measure how systems scale with the number of entities, meshes,
+// materials and lights, without shipping large assets.
+namespace StressScene {
+
+struct Parameters
+{
+    std::size_t entities = 1000;
+    std::size_t unique_meshes = 16;
+    std::size_t materials = 8;
+
+    // Levels of children below every root entity, 0 for a flat scene.
+    unsigned hierarchy_depth = 0;
+
+    std::size_t point_lights = 16;
+
+    // Fraction of entities rotating every fixed step. Their children move along with them.
+    float moving_fraction = 0.1F;
+
+    std::uint32_t seed = 1;
+};
+
+// Rotates an entity of a stress scene, see animate().
+struct Mover
+{
+    glm::vec3 axis;
+    float speed; // Radians per second
+};
+
+struct Caches
+{
+    entt::resource_cache<Mesh>& mesh_cache;
+    entt::resource_cache<Material>& material_cache;
+    entt::resource_cache<Image>& image_cache;
+    entt::resource_cache<Shader, ShaderLoader>& shader_cache;
+};
+
+// Spawns the entities with their GPU meshes and materials and the point lights. Entities are
+// laid out on a grid, every hierarchy as a chain going upwards from its root. Their components
+// are recorded by parallel jobs into the CommandQueue of the registry and appear at its next
+// sync point.
+void spawn(entt::registry& registry, Caches const& caches, Parameters const& parameters);
+
+// Advances the rotation of all movers by one fixed step.
+void animate(entt::registry& registry);
+
+} // namespace StressScene
@@ -0,0 +1,161 @@
+#include "image_diff.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <spdlog/spdlog.h>
+#include <stb_image.h>
+
+namespace ImageDiff {
+
+namespace {
+
+constexpr std::size_t CHANNELS = 4;
+
+auto linear_table() -> std::array<float, 256> const&
+{
+    static auto const table = [] {
+        std::array<float, 256> table{};
+        for (std::size_t i = 0; i < table.size(); ++i) {
+            float const value = static_cast<float>(i) / 255.0F;
+            table[i] = value <= 0.04045F ? value / 12.92F
+                                         : std::pow((value + 0.055F) / 1.055F, 2.4F);
+        }
+        return table;
+    }();
+
+    return table;
+}
+
+// CIELAB relative to the D65 white point
+auto to_lab(std::uint8_t const* rgb) -> glm::vec3
+{
+    auto const& linear = linear_table();
+    glm::vec3 const color{linear[rgb[0]], linear[rgb[1]], linear[rgb[2]]};
+
+    glm::vec3 xyz{glm::dot(color, glm::vec3(0.4124F, 0.3576F, 0.1805F)) / 0.95047F,
+                  glm::dot(color, glm::vec3(0.2126F, 0.7152F, 0.0722F)),
+                  glm::dot(color, glm::vec3(0.0193F, 0.1192F, 0.9505F)) / 1.08883F};
+
+    auto f = [](float t) {
+        constexpr float EPSILON = 216.0F / 24389.0F;
+        constexpr float KAPPA = 24389.0F / 27.0F;
+        return t > EPSILON ? std::cbrt(t) : (KAPPA * t + 16.0F) / 116.0F;
+    };
+
+    glm::vec3 const f_xyz{f(xyz.x), f(xyz.y), f(xyz.z)};
+    return {116.0F * f_xyz.y - 16.0F, 500.0F * (f_xyz.x - f_xyz.y), 200.0F * (f_xyz.y - f_xyz.z)};
+}
+
+auto to_lab(Pixels const& pixels) -> std::vector<glm::vec3>
+{
+    std::vector<glm::vec3> lab(pixels.rgba.size() / CHANNELS);
+    for (std::size_t i = 0; i < lab.size(); ++i) {
+        lab[i] = to_lab(&pixels.rgba[i * CHANNELS]);
+    }
+    return lab;
+}
+
+} // namespace
+
+auto load(std::filesystem::path const& path) -> std::optional<Pixels>
+{
+    int width{};
+    int height{};
+    int components{};
+
+    std::uint8_t* image = stbi_load(
+        path.string().c_str(), &width, &height, &components, static_cast<int>(CHANNELS));
+    if (image == nullptr) {
+        spdlog::error(R"(Could not load image "{}": {})", path.string(), stbi_failure_reason());
+        return {};
+    }
+
+    std::size_t const size = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+
+    Pixels pixels{.dimensions = glm::u32vec2(width, height),
+                  .rgba = std::vector<std::uint8_t>(image, image + size * CHANNELS)};
+    stbi_image_free(image);
+
+    return pixels;
+}
+
+auto from_bottom_to_top(glm::u32vec2 dimensions, std::vector<std::uint8_t> const& rgba) -> Pixels
+{
+    std::size_t const row_size = dimensions.x * CHANNELS;
+
+    Pixels pixels{.dimensions = dimensions, .rgba = std::vector<std::uint8_t>(rgba.size())};
+    for (std::size_t y = 0; y < dimensions.y; ++y) {
+        auto source = rgba.begin() + static_cast<std::ptrdiff_t>((dimensions.y - 1 - y) * row_size);
+        auto destination = pixels.rgba.begin() + static_cast<std::ptrdiff_t>(y * row_size);
+        std::copy_n(source, row_size, destination);
+    }
+
+    return pixels;
+}
+
+auto compare(Pixels const& reference, Pixels const& candidate, Tolerance const& tolerance)
+    -> std::optional<Result>
+{
+    if (reference.dimensions != candidate.dimensions) {
+        return {};
+    }
+
+    auto const reference_lab = to_lab(reference);
+    auto const candidate_lab = to_lab(candidate);
+
+    auto const width = static_cast<int>(reference.dimensions.x);
+    auto const height = static_cast<int>(reference.dimensions.y);
+    auto const radius = static_cast<int>(tolerance.search_radius);
+
+    Result result;
+    result.visualization.dimensions = reference.dimensions;
+    result.visualization.rgba.resize(reference.rgba.size());
+    double delta_e_sum = 0.0;
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            auto const index = static_cast<std::size_t>(y * width + x);
+            glm::vec3 const color = candidate_lab[index];
+
+            float const delta_e = glm::distance(reference_lab[index], color);
+            delta_e_sum += delta_e;
+            result.max_delta_e = std::max(result.max_delta_e, delta_e);
+
+            bool matches = delta_e <= tolerance.delta_e;
+            for (int dy = -radius; dy <= radius && !matches; ++dy) {
+                for (int dx = -radius; dx <= radius && !matches; ++dx) {
+                    int const nx = std::clamp(x + dx, 0, width - 1);
+                    int const ny = std::clamp(y + dy, 0, height - 1);
+                    auto const neighbor = static_cast<std::size_t>(ny * width + nx);
+
+                    matches = glm::distance(reference_lab[neighbor], color) <= tolerance.delta_e;
+                }
+            }
+
+            auto* output = &result.visualization.rgba[index * CHANNELS];
+            if (matches) {
+                // Lightness in [0, 100] to half the range, so differences stand out
+                auto const gray = static_cast<std::uint8_t>(reference_lab[index].x * 1.275F);
+                output[0] = output[1] = output[2] = gray;
+            } else {
+                ++result.differing_pixels;
+                output[0] = 255;
+                output[1] = output[2] = 0;
+            }
+            output[3] = 255;
+        }
+    }
+
+    auto const pixel_count = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    if (pixel_count != 0) {
+        result.mean_delta_e = static_cast<float>(delta_e_sum / static_cast<double>(pixel_count));
+        result.differing_fraction =
+            static_cast<float>(result.differing_pixels) / static_cast<float>(pixel_count);
+    }
+    result.passed = result.differing_fraction <= tolerance.max_differing_fraction;
+
+    return result;
+}
+
+} // namespace ImageDiff
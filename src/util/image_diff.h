@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <optional>
+#include <vector>
+
+// Perceptual comparison of rendered frames against reference images. Pixels are compared by
+// their CIELAB color difference, so changes the eye barely notices, e.g. of dithering, pass.
+namespace ImageDiff {
+
+// 8 bit sRGB RGBA pixels, rows ordered top to bottom.
+struct Pixels
+{
+    glm::u32vec2 dimensions{};
+    std::vector<std::uint8_t> rgba;
+};
+
+struct Tolerance
+{
+    // CIE76 color difference below which a pixel matches. 2.3 is a just noticeable difference.
+    float delta_e = 2.3F;
+
+    // A pixel also matches if a pixel this close in the reference does, which allows edges to
+    // shift by a pixel, e.g. when antialiasing changes.
+    unsigned search_radius = 1;
+
+    // Fraction of pixels allowed to differ
+    float max_differing_fraction = 0.0F;
+};
+
+struct Result
+{
+    float max_delta_e{};
+    float mean_delta_e{};
+    std::size_t differing_pixels{};
+    float differing_fraction{};
+    bool passed{};
+
+    // The reference in gray with differing pixels in red
+    Pixels visualization;
+};
+
+auto load(std::filesystem::path const& path) -> std::optional<Pixels>;
+
+// Flips rows read back from OpenGL into top to bottom order.
+auto from_bottom_to_top(glm::u32vec2 dimensions, std::vector<std::uint8_t> const& rgba) -> Pixels;
+
+// Returns nothing if the dimensions differ.
+auto compare(Pixels const& reference, Pixels const& candidate, Tolerance const& tolerance)
+    -> std::optional<Result>;
+
+} // namespace ImageDiff
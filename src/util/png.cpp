@@ -0,0 +1,146 @@
+#include "png.h"
+
+#include <array>
+#include <fstream>
+#include <spdlog/spdlog.h>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t CHANNELS = 4;
+
+// Largest block of a stored deflate stream
+constexpr std::size_t MAX_STORED_BLOCK = 0xFFFF;
+
+auto crc_table() -> std::array<std::uint32_t, 256> const&
+{
+    static auto const table = [] {
+        std::array<std::uint32_t, 256> table{};
+        for (std::uint32_t n = 0; n < table.size(); ++n) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1U) != 0 ? 0xEDB88320U ^ (c >> 1U) : c >> 1U;
+            }
+            table[n] = c;
+        }
+        return table;
+    }();
+
+    return table;
+}
+
+void append_u32(std::vector<std::uint8_t>& data, std::uint32_t value)
+{
+    data.push_back(static_cast<std::uint8_t>(value >> 24U));
+    data.push_back(static_cast<std::uint8_t>(value >> 16U));
+    data.push_back(static_cast<std::uint8_t>(value >> 8U));
+    data.push_back(static_cast<std::uint8_t>(value));
+}
+
+void append_chunk(std::vector<std::uint8_t>& png,
+                  std::string_view type,
+                  std::vector<std::uint8_t> const& data)
+{
+    append_u32(png, static_cast<std::uint32_t>(data.size()));
+
+    auto const checked_begin = static_cast<std::ptrdiff_t>(png.size());
+    png.insert(png.end(), type.begin(), type.end());
+    png.insert(png.end(), data.begin(), data.end());
+
+    // The checksum covers type and data
+    std::uint32_t crc = 0xFFFFFFFFU;
+    for (auto it = png.cbegin() + checked_begin; it != png.cend(); ++it) {
+        crc = crc_table()[(crc ^ *it) & 0xFFU] ^ (crc >> 8U);
+    }
+    append_u32(png, crc ^ 0xFFFFFFFFU);
+}
+
+// Wraps the data into a zlib stream of uncompressed deflate blocks.
+auto zlib_stored(std::vector<std::uint8_t> const& data) -> std::vector<std::uint8_t>
+{
+    std::vector<std::uint8_t> stream{0x78, 0x01};
+    stream.reserve(data.size() + data.size() / MAX_STORED_BLOCK * 5 + 16);
+
+    std::size_t offset = 0;
+    do {
+        std::size_t const size = std::min(MAX_STORED_BLOCK, data.size() - offset);
+        bool const last = offset + size == data.size();
+
+        stream.push_back(last ? 1 : 0);
+        stream.push_back(static_cast<std::uint8_t>(size));
+        stream.push_back(static_cast<std::uint8_t>(size >> 8U));
+        stream.push_back(static_cast<std::uint8_t>(~size));
+        stream.push_back(static_cast<std::uint8_t>(~size >> 8U));
+        stream.insert(stream.end(), data.begin() + offset, data.begin() + offset + size);
+
+        offset += size;
+    } while (offset < data.size());
+
+    std::uint32_t a = 1;
+    std::uint32_t b = 0;
+    for (auto byte : data) {
+        a = (a + byte) % 65521U;
+        b = (b + a) % 65521U;
+    }
+    append_u32(stream, (b << 16U) | a);
+
+    return stream;
+}
+
+} // namespace
+
+auto Png::encode(glm::u32vec2 dimensions,
+                 std::span<std::uint8_t const> pixels,
+                 RowOrder row_order) -> std::vector<std::uint8_t>
+{
+    std::size_t const row_size = dimensions.x * CHANNELS;
+    if (pixels.size() != row_size * dimensions.y) {
+        return {};
+    }
+
+    std::vector<std::uint8_t> png{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+    std::vector<std::uint8_t> header;
+    append_u32(header, dimensions.x);
+    append_u32(header, dimensions.y);
+    header.insert(header.end(), {8, 6, 0, 0, 0}); // 8 bit RGBA, no interlacing
+    append_chunk(png, "IHDR", header);
+
+    // Every row starts with its filter type, none. PNG rows go from top to bottom.
+    std::vector<std::uint8_t> rows;
+    rows.reserve((row_size + 1) * dimensions.y);
+    for (std::size_t i = 0; i < dimensions.y; ++i) {
+        std::size_t const y = row_order == RowOrder::TopToBottom ? i : dimensions.y - 1 - i;
+
+        rows.push_back(0);
+        auto row = pixels.subspan(y * row_size, row_size);
+        rows.insert(rows.end(), row.begin(), row.end());
+    }
+
+    append_chunk(png, "IDAT", zlib_stored(rows));
+    append_chunk(png, "IEND", {});
+
+    return png;
+}
+
+auto Png::write(std::filesystem::path const& path,
+                glm::u32vec2 dimensions,
+                std::span<std::uint8_t const> pixels,
+                RowOrder row_order) -> bool
+{
+    std::vector<std::uint8_t> png = encode(dimensions, pixels, row_order);
+    if (png.empty()) {
+        spdlog::error(R"(Image data of "{}" does not match its dimensions)", path.string());
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        spdlog::error(R"(Could not write image "{}")", path.string());
+        return false;
+    }
+
+    file.write(reinterpret_cast<char const*>(png.data()), static_cast<std::streamsize>(png.size()));
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+namespace Png {
+
+enum class RowOrder
+{
+    BottomToTop, // As read back from OpenGL
+    TopToBottom,
+};
+
+// Encodes 8 bit RGBA pixels. The image data is stored uncompressed, which keeps the encoder
+// small at the cost of file size. Returns nothing if the pixels do not match the dimensions.
+auto encode(glm::u32vec2 dimensions,
+            std::span<std::uint8_t const> pixels,
+            RowOrder row_order = RowOrder::BottomToTop) -> std::vector<std::uint8_t>;
+
+auto write(std::filesystem::path const& path,
+           glm::u32vec2 dimensions,
+           std::span<std::uint8_t const> pixels,
+           RowOrder row_order = RowOrder::BottomToTop) -> bool;
+
+} // namespace Png
@@ -0,0 +1,201 @@
+#include "profiler.h"
+
+#ifdef FEVER_PROFILING
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+namespace Profiler {
+
+namespace {
+
+struct Event
+{
+    char const* name;
+    std::int64_t start;
+    std::int64_t end;
+};
+
+// Events are appended in chunks, so that recording never moves events the exporter may be
+// reading. Only the owning thread writes, publishing every event with the count.
+struct Chunk
+{
+    static constexpr std::size_t SIZE = 4096;
+
+    std::array<Event, SIZE> events;
+    std::atomic<std::size_t> count{};
+};
+
+// Keeps the most recent MAX_CHUNKS chunks of a thread, so that long sessions record in bounded
+// memory. Filling a chunk takes the lock to recycle the oldest one, which the exporter holds
+// while reading, so it never sees a chunk being rewritten.
+struct ThreadBuffer
+{
+    static constexpr std::size_t MAX_CHUNKS = 32;
+
+    explicit ThreadBuffer(std::uint32_t id) : id(id)
+    {
+        chunks.push_back(std::make_unique<Chunk>());
+        tail = chunks.back().get();
+    }
+
+    void next_chunk()
+    {
+        std::lock_guard const lock(mutex);
+
+        if (chunks.size() < MAX_CHUNKS) {
+            chunks.push_back(std::make_unique<Chunk>());
+        } else {
+            chunks.push_back(std::move(chunks.front()));
+            chunks.pop_front();
+            dropped += chunks.back()->count.load(std::memory_order_relaxed);
+            chunks.back()->count.store(0, std::memory_order_relaxed);
+        }
+
+        tail = chunks.back().get();
+    }
+
+    std::uint32_t id;
+    std::atomic<char const*> name{};
+
+    std::mutex mutex;
+    std::deque<std::unique_ptr<Chunk>> chunks;
+    std::uint64_t dropped{};
+
+    // Only accessed by the owning thread.
+    Chunk* tail;
+};
+
+// Buffers of all threads that recorded a zone. They outlive their threads, so that zones of
+// finished threads are still exported.
+struct Buffers
+{
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+auto buffers() -> Buffers&
+{
+    static Buffers instance;
+    return instance;
+}
+
+auto thread_buffer() -> ThreadBuffer&
+{
+    // Registering takes the lock once per thread, recording afterwards does not.
+    thread_local ThreadBuffer* buffer = [] {
+        auto& all = buffers();
+        std::lock_guard const lock(all.mutex);
+
+        auto id = static_cast<std::uint32_t>(all.buffers.size());
+        return all.buffers.emplace_back(std::make_unique<ThreadBuffer>(id)).get();
+    }();
+
+    return *buffer;
+}
+
+auto now() -> std::int64_t
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                buffers().epoch)
+        .count();
+}
+
+} // namespace
+
+Zone::Zone(char const* name) : name(name), start(now()) {}
+
+Zone::~Zone()
+{
+    auto end = now();
+    auto& buffer = thread_buffer();
+
+    std::size_t count = buffer.tail->count.load(std::memory_order_relaxed);
+    if (count == Chunk::SIZE) {
+        buffer.next_chunk();
+        count = 0;
+    }
+
+    buffer.tail->events[count] = Event{.name = name, .start = start, .end = end};
+    buffer.tail->count.store(count + 1, std::memory_order_release);
+}
+
+void set_thread_name(char const* name)
+{
+    thread_buffer().name.store(name, std::memory_order_release);
+}
+
+void write_chrome_trace(std::filesystem::path const& path)
+{
+    std::ofstream file(path);
+    if (!file) {
+        spdlog::error(R"(Could not write trace "{}")", path.string());
+        return;
+    }
+
+    auto& all = buffers();
+    std::lock_guard const lock(all.mutex);
+
+    // Events are streamed one by one rather than building the whole document in memory.
+    bool first = true;
+    auto write_event = [&file, &first](nlohmann::json const& event) {
+        file << (first ? "\n" : ",\n") << event;
+        first = false;
+    };
+
+    std::uint64_t dropped = 0;
+
+    file << R"({"displayTimeUnit":"ms","traceEvents":[)";
+
+    for (auto const& buffer : all.buffers) {
+        if (char const* name = buffer->name.load(std::memory_order_acquire); name != nullptr) {
+            write_event({{"name", "thread_name"},
+                         {"ph", "M"},
+                         {"pid", 1},
+                         {"tid", buffer->id},
+                         {"args", {{"name", name}}}});
+        }
+
+        std::lock_guard const buffer_lock(buffer->mutex);
+        dropped += buffer->dropped;
+
+        for (auto const& chunk : buffer->chunks) {
+            std::size_t count = chunk->count.load(std::memory_order_acquire);
+
+            for (std::size_t i = 0; i < count; ++i) {
+                auto const& event = chunk->events[i];
+
+                // Complete events with timestamps in microseconds
+                write_event({{"name", event.name},
+                             {"ph", "X"},
+                             {"pid", 1},
+                             {"tid", buffer->id},
+                             {"ts", static_cast<double>(event.start) / 1e3},
+                             {"dur", static_cast<double>(event.end - event.start) / 1e3}});
+            }
+        }
+    }
+
+    file << "\n]}\n";
+
+    if (dropped != 0) {
+        spdlog::warn("Trace is missing the {} oldest zones, only the most recent ones are kept",
+                     dropped);
+    }
+
+    spdlog::info(R"(Wrote trace "{}")", path.string());
+}
+
+} // namespace Profiler
+
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+// Scoped CPU profiling zones, compiled in with the FEVER_PROFILING option. Zones are recorded
+// into bounded per-thread buffers, keeping the most recent ones, and exported as Chrome trace
+// JSON, which Perfetto and chrome://tracing open. Without the option, zones compile to nothing.
+
+#ifdef FEVER_PROFILING
+
+#include <cstdint>
+#include <filesystem>
+
+namespace Profiler {
+
+class Zone
+{
+public:
+    // The name has to outlive the profiler, e.g. a string literal.
+    explicit Zone(char const* name);
+    ~Zone();
+
+    Zone(Zone const&) = delete;
+    auto operator=(Zone const&) -> Zone& = delete;
+    Zone(Zone&&) = delete;
+    auto operator=(Zone&&) -> Zone& = delete;
+
+private:
+    char const* name;
+    std::int64_t start;
+};
+
+// Names the calling thread in the trace. The name has to outlive the profiler.
+void set_thread_name(char const* name);
+
+// Streams all zones closed so far and still buffered to the file.
+void write_chrome_trace(std::filesystem::path const& path);
+
+} // namespace Profiler
+
+#define FEVER_PROFILE_CONCAT_IMPL(a, b) a##b
+#define FEVER_PROFILE_CONCAT(a, b) FEVER_PROFILE_CONCAT_IMPL(a, b)
+
+#define FEVER_PROFILE_ZONE(name) \
+    Profiler::Zone const FEVER_PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#define FEVER_PROFILE_THREAD(name) Profiler::set_thread_name(name)
+
+#else
+
+#define FEVER_PROFILE_ZONE(name) static_cast<void>(0)
+#define FEVER_PROFILE_THREAD(name) static_cast<void>(0)
+
+#endif
@@ -0,0 +1,72 @@
+#include "y4m.h"
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace {
+
+constexpr std::size_t CHANNELS = 4;
+
+auto clamp_byte(int value) -> std::uint8_t
+{
+    return static_cast<std::uint8_t>(std::clamp(value, 0, 255));
+}
+
+} // namespace
+
+Y4mWriter::Y4mWriter(std::filesystem::path const& path,
+                     glm::u32vec2 dimensions,
+                     unsigned frame_rate) :
+    file(path, std::ios::binary),
+    video_dimensions(dimensions),
+    planes(static_cast<std::size_t>(dimensions.x) * dimensions.y * 3)
+{
+    if (!file) {
+        spdlog::error(R"(Could not write video "{}")", path.string());
+        return;
+    }
+
+    file << "YUV4MPEG2 W" << dimensions.x << " H" << dimensions.y << " F" << frame_rate
+         << ":1 Ip A1:1 C444\n";
+}
+
+auto Y4mWriter::write(glm::u32vec2 frame_dimensions, std::span<std::uint8_t const> pixels)
+    -> bool
+{
+    std::size_t const plane_size =
+        static_cast<std::size_t>(video_dimensions.x) * video_dimensions.y;
+    if (frame_dimensions != video_dimensions || pixels.size() != plane_size * CHANNELS) {
+        spdlog::warn("Frame of {}x{} does not match the video of {}x{}",
+                     frame_dimensions.x,
+                     frame_dimensions.y,
+                     video_dimensions.x,
+                     video_dimensions.y);
+        return false;
+    }
+
+    // Limited range BT.601 in 8 bit fixed point. Video rows go from top to bottom.
+    std::size_t index = 0;
+    for (std::size_t y = video_dimensions.y; y-- > 0;) {
+        auto const* pixel = &pixels[y * video_dimensions.x * CHANNELS];
+
+        for (std::size_t x = 0; x < video_dimensions.x; ++x, pixel += CHANNELS, ++index) {
+            int const r = pixel[0];
+            int const g = pixel[1];
+            int const b = pixel[2];
+
+            int const luma = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+            int const blue_difference = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+            int const red_difference = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+
+            planes[index] = clamp_byte(luma);
+            planes[plane_size + index] = clamp_byte(blue_difference);
+            planes[2 * plane_size + index] = clamp_byte(red_difference);
+        }
+    }
+
+    file << "FRAME\n";
+    file.write(reinterpret_cast<char const*>(planes.data()),
+               static_cast<std::streamsize>(planes.size()));
+
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+// Streams frames into an uncompressed YUV4MPEG2 video, which ffmpeg and most players read. Frames
+// are stored as 4:4:4 BT.601, so converting them costs no more than copying.
+class Y4mWriter
+{
+public:
+    Y4mWriter(std::filesystem::path const& path, glm::u32vec2 dimensions, unsigned frame_rate);
+
+    // Appends 8 bit RGBA pixels, rows ordered bottom to top as read back from OpenGL. All
+    // frames need the dimensions of the video.
+    auto write(glm::u32vec2 frame_dimensions, std::span<std::uint8_t const> pixels) -> bool;
+
+    [[nodiscard]] auto dimensions() const -> glm::u32vec2 { return video_dimensions; }
+
+private:
+    std::ofstream file;
+    glm::u32vec2 video_dimensions;
+
+    // Y, U and V planes of the current frame
+    std::vector<std::uint8_t> planes;
+};
@@ -7,13 +7,11 @@
 #include <GLFW/glfw3.h>
 #include <spdlog/spdlog.h>
 
-static constexpr unsigned INIT_WINDOW_WIDTH = 1280;
-static constexpr unsigned INIT_WINDOW_HEIGHT = 720;
-
-Window::Window(entt::dispatcher& event_dispatcher) : event_dispatcher(event_dispatcher)
+Window::Window(entt::dispatcher& event_dispatcher, Options const& options)
+    : event_dispatcher(event_dispatcher)
 {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
 #ifndef NDEBUG
@@ -21,11 +19,25 @@ Window::Window(entt::dispatcher& event_dispatcher) : event_dispatcher(event_disp
     glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
 #else
     // Maximize in release build
-    glfwWindowHint(GLFW_MAXIMIZED, GLFW_TRUE);
+    glfwWindowHint(GLFW_MAXIMIZED, options.headless ? GLFW_FALSE : GLFW_TRUE);
 #endif
 
+    if (options.headless) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+        if (glfwGetPlatform() == GLFW_PLATFORM_NULL) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        }
+#endif
+    }
+
     glfw_window = std::shared_ptr<GLFWwindow>(
-        glfwCreateWindow(INIT_WINDOW_WIDTH, INIT_WINDOW_HEIGHT, "OpenGL", nullptr, nullptr),
+        glfwCreateWindow(static_cast<int>(options.dimensions.x),
+                         static_cast<int>(options.dimensions.y),
+                         "OpenGL",
+                         nullptr,
+                         nullptr),
         [](GLFWwindow* window) { glfwDestroyWindow(window); });
 
     if (!glfw_window) {
@@ -35,6 +47,11 @@ Window::Window(entt::dispatcher& event_dispatcher) : event_dispatcher(event_disp
     // Create OpenGL context
     glfwMakeContextCurrent(glfw_window.get());
 
+    // There is no display to synchronize a headless run with
+    if (options.headless) {
+        glfwSwapInterval(0);
+    }
+
     // Callbacks
     glfwSetWindowUserPointer(glfw_window.get(), this);
     glfwSetKeyCallback(glfw_window.get(), key_callback);
@@ -50,6 +67,18 @@ Window::Window(entt::dispatcher& event_dispatcher) : event_dispatcher(event_disp
     }
 }
 
+void Window::prefer_headless_platform()
+{
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+    if (glfwPlatformSupported(GLFW_PLATFORM_NULL) == GLFW_TRUE) {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+        return;
+    }
+#endif
+
+    spdlog::warn("GLFW null platform not available, headless mode needs a display");
+}
+
 void Window::glfw_error_callback(int error, char const* description)
 {
     spdlog::warn("GLFW [{:d}]: {:s}\n", error, description);
@@ -113,7 +142,7 @@ auto Window::physical_dimensions() const -> glm::u32vec2
 
 void Window::mouse_catching(entt::registry& registry) const
 {
-    auto& mouse_catched = registry.ctx().emplace<MouseCatched>(MouseCatched{.catched = false});
+    auto& mouse_catched = registry.ctx().get<MouseCatched>();
     auto const& key_state = registry.ctx().get<Input::State<Input::KeyCode>>();
 
     if (key_state.just_pressed(Input::KeyCode{GLFW_KEY_LEFT_CONTROL})) {
@@ -138,8 +167,8 @@ void Window::update_descriptor(entt::registry& registry) const
 {
     auto dimensions = logical_dimensions();
 
-    registry.ctx().erase<Descriptor>();
-    registry.ctx().emplace<Descriptor>(Descriptor{
+    registry.ctx().insert_or_assign(Descriptor{
         .logical_dimensions = dimensions,
+        .physical_dimensions = physical_dimensions(),
         .aspect_ratio = static_cast<float>(dimensions.x) / static_cast<float>(dimensions.y)});
 }
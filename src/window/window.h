@@ -19,13 +19,26 @@ public:
     struct Descriptor
     {
         glm::u32vec2 logical_dimensions;
+        glm::u32vec2 physical_dimensions;
         float aspect_ratio{};
     };
 
     struct ResizeEvent
     {};
 
-    Window(entt::dispatcher& event_dispatcher);
+    struct Options
+    {
+        // Renders into an invisible window of a fixed size.
+        bool headless = false;
+        glm::u32vec2 dimensions{1280, 720};
+    };
+
+    Window(entt::dispatcher& event_dispatcher, Options const& options);
+
+    // Selects the null platform of GLFW, which creates OSMesa contexts and needs no display
+    // server, e.g. Mesa llvmpipe in a CI container. Has to be called before glfwInit(). Without
+    // GLFW 3.4 or OSMesa, headless windows fall back to invisible windows of the native platform.
+    static void prefer_headless_platform();
 
     [[nodiscard]] auto handle() -> GLFWwindow& { return *glfw_window; }
     [[nodiscard]] auto physical_dimensions() const -> glm::u32vec2;